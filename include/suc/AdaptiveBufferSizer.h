@@ -0,0 +1,85 @@
+#pragma once
+#ifndef SUCADAPTIVEBUFFERSIZER_H
+#define SUCADAPTIVEBUFFERSIZER_H
+
+#include "SocketUtility.h"
+
+namespace suc
+{
+	/* +++ AdaptiveBufferSizer +++
+	Predicts the size of the next receive buffer of a connection from the sizes of its
+	recent reads, so that connections with small messages do not hold large buffers and
+	bulk transfers do not need many reads into small ones.
+
+	Sizes are picked from a table of size classes: steps of 16 bytes up to 512 bytes and
+	powers of two above. The prediction grows by several classes at once as soon as a read
+	fills the whole buffer and shrinks by one class only after two consecutive reads that
+	would have fit into the next smaller class. */
+	class AdaptiveBufferSizer
+	{
+	public:
+		struct Stats
+		{
+			size_t nextSize;	// The current prediction
+			ulong reads;
+			ulong bytesRead;
+			ulong increases;
+			ulong decreases;
+		};
+
+		/**
+		 * All sizes are rounded to the enclosing size classes.
+		 *
+		 * @param size_t minimum The prediction never drops below this size
+		 * @param size_t initial The first prediction
+		 * @param size_t maximum The prediction never exceeds this size
+		 */
+		AdaptiveBufferSizer(size_t minimum = DEFAULT_MINIMUM,
+							size_t initial = DEFAULT_INITIAL,
+							size_t maximum = DEFAULT_MAXIMUM) noexcept;
+
+		/**
+		 * @return size_t The buffer size to use for the next read.
+		 */
+		[[nodiscard]]
+		auto nextSize() const noexcept -> size_t;
+
+		/**
+		 * Adjust the prediction to the result of a read.
+		 *
+		 * @param size_t bytesRead The number of bytes that have been read into a buffer of
+		 *                         nextSize() bytes
+		 */
+		void record(size_t bytesRead) noexcept;
+
+		[[nodiscard]]
+		auto getStats() const noexcept -> Stats;
+
+	private:
+		static constexpr size_t DEFAULT_MINIMUM = 64;
+		static constexpr size_t DEFAULT_INITIAL = 2048;
+		static constexpr size_t DEFAULT_MAXIMUM = 64 * 1024;
+
+		static constexpr size_t INDEX_INCREMENT = 4;
+		static constexpr size_t INDEX_DECREMENT = 1;
+
+		/**
+		 * @return size_t Index of the smallest size class that is at least size.
+		 */
+		static auto findSizeClass(size_t size) noexcept -> size_t;
+
+		size_t minIndex;
+		size_t maxIndex;
+		size_t index;
+		bool decreaseNow{ false };
+
+		ulong reads{ 0 };
+		ulong bytesRead{ 0 };
+		ulong increases{ 0 };
+		ulong decreases{ 0 };
+	};
+} // namespace suc
+
+
+
+#endif
@@ -2,12 +2,15 @@
 #ifndef ASYNC_H
 #define ASYNC_H
 
+#include <atomic>
 #include <functional>
 #include <future>
 #include <thread>
+#include <vector>
 
 #include "ServerSocket.h"
 #include "ClientSocket.h"
+#include "WorkerPool.h"
 
 namespace suc
 {
@@ -18,7 +21,7 @@ namespace suc
 	{
 	public:
 		AsyncServer(int port, int family, callback<ClientSocket> onConnection = [](ClientSocket) {});
-		AsyncServer(AsyncServer&&) noexcept = default;
+		AsyncServer(AsyncServer&&) noexcept = delete;
 		~AsyncServer() noexcept;
 
 		AsyncServer(const AsyncServer&) = delete;
@@ -27,7 +30,7 @@ namespace suc
 
 		/**
 		 * Starts the server.
-		 * The server runs in a detached thread.
+		 * The server runs in one detached thread per reactor, see setReactorCount().
 		 * 
 		 * The server waits for incoming connections and passes them to the onConnection callback.
 		 * When an error occurs that requires the server to terminate, onError is called and the
@@ -37,6 +40,9 @@ namespace suc
 		 * has been stopped (or an error has occured for that matter) restarts the server on the same
 		 * port and with the same family.
 		 * 
+		 * Connections are accepted with the I/O engine selected by setIoEngine() at the time
+		 * of the call.
+		 * 
 		 * Throws an exception if connect() or bind() of the underlying socket fail.
 		 * 
 		 * @throw suc::suc_error
@@ -44,10 +50,57 @@ namespace suc
 		void start();
 
 		/**
-		 * Stops the server.
+		 * Stops the server and waits for the reactor threads to terminate. A reactor
+		 * thread that calls stop(), e.g. from onConnection, does not wait for itself.
 		 */
 		void stop();
 
+		/**
+		 * Sets the number of reactor threads that accept connections. Takes effect on the
+		 * next call to start().
+		 * 
+		 * With more than one reactor, each reactor thread binds its own SO_REUSEPORT socket to
+		 * the server's port and the kernel distributes incoming connections among them. The
+		 * onConnection callback is then invoked concurrently from all reactor threads.
+		 * 
+		 * @param uint count Number of reactors. Defaults to 1; 0 is treated as 1.
+		 */
+		void setReactorCount(uint count);
+
+		/**
+		 * Set the length of the listen backlog of the server's sockets. Takes effect on the
+		 * next call to start().
+		 * 
+		 * @param int backlog See ServerSocketOptions::backlog. Defaults to SOMAXCONN.
+		 */
+		void setBacklog(int backlog);
+
+		/**
+		 * Hands new connections to a pool of worker threads instead of calling onConnection on
+		 * the reactor thread. The reactors then only accept connections, so a slow handler
+		 * does not delay other clients. Takes effect on the next call to start().
+		 * 
+		 * When all worker queues are full, the reactors stop accepting until a slot frees up
+		 * and further connections wait in the listen backlog.
+		 * 
+		 * @param uint   threadCount   Number of worker threads. 0 disables the pool, which is
+		 *                             the default.
+		 * @param size_t queueCapacity Maximum number of connections waiting per worker
+		 */
+		void setWorkerCount(uint threadCount, size_t queueCapacity = 1024);
+
+		/**
+		 * @return Queue depth and handler latency of the worker pool, if one is in use.
+		 */
+		[[nodiscard]]
+		auto getWorkerStats() const -> std::optional<WorkerPool::Stats>;
+
+		/**
+		 * @return bool True if at least one reactor thread is running.
+		 */
+		[[nodiscard]]
+		bool isRunning() const noexcept;
+
 		/**
 		 * Called when a client connects to the server.
 		 * 
@@ -63,11 +116,22 @@ namespace suc
 		void onError(std::function<void(const suc_error&)> f);
 
 		/**
-		 * Called when the server thread terminates.
+		 * Called when the last reactor thread terminates.
 		 */
 		void onTerminate(std::function<void(void)> f);
 
 	private:
+		static constexpr size_t ACCEPT_BATCH_SIZE = 64;
+		// Pause before accepting again after the descriptor or memory limits were hit
+		static constexpr int ACCEPT_RETRY_DELAY = 10;
+
+		void runAcceptLoop(ServerSocket& socket);
+		void runIoUringAcceptLoop(ServerSocket& socket);
+		void handleReactorError(const suc_error& err);
+		void dispatchConnection(ClientSocket client);
+		void closeSockets();
+		void joinReactors();
+
 		const int port;
 		const int family;
 
@@ -75,9 +139,15 @@ namespace suc
 		callback<const suc_error&> onErrorFunc;
 		callback<> onTerminateFunc;
 
-		ServerSocket socket{};
-		bool shouldClose{ false }; // Indicates whether stop() has been called or an error occured
-		bool isRunning{ false };
+		uint reactorCount{ 1 };
+		int backlog{ SOMAXCONN };
+		uint workerCount{ 0 };
+		size_t workerQueueCapacity{ 0 };
+		std::unique_ptr<WorkerPool> workers;
+		std::vector<ServerSocket> sockets; // One per reactor
+		std::vector<std::thread> reactors;
+		std::atomic<bool> shouldClose{ false }; // Indicates whether stop() has been called or an error occured
+		std::atomic<uint> runningReactors{ 0 };
 	};
 } // namespace suc
 
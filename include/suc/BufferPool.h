@@ -0,0 +1,181 @@
+#pragma once
+#ifndef SUCBUFFERPOOL_H
+#define SUCBUFFERPOOL_H
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "SocketUtility.h"
+
+namespace suc
+{
+	/* +++ BufferPool +++
+	A pool of network buffers in a few fixed size classes (2, 4, 16 and 64 KiB).
+
+	Every thread has its own pool, so allocating and freeing a buffer is a push or pop on a
+	thread-local free list and does not contend on a lock. Free lists are refilled in
+	batches from a shared depot, and the depot from slabs of 2 MiB that are carved into
+	blocks of one size class. Slabs are never returned to the operating system; the free
+	blocks of a thread that exits are handed back to the depot.
+
+	A buffer may be freed on a different thread than the one that allocated it. Requests
+	above the largest size class are forwarded to operator new. */
+	class BufferPool
+	{
+	public:
+		static constexpr std::array<size_t, 4> SIZE_CLASSES{
+			2 * 1024, 4 * 1024, 16 * 1024, 64 * 1024
+		};
+		static constexpr size_t MAX_POOLED_SIZE = SIZE_CLASSES.back();
+		static constexpr size_t SLAB_SIZE = 2 * 1024 * 1024;
+
+		struct Stats
+		{
+			ulong hits;				// Allocations served from the thread's free lists
+			ulong misses;			// Allocations that had to refill a free list or were too large
+			size_t bytesResident;	// Slab memory mapped by all pools together
+		};
+
+		/**
+		 * @return BufferPool& The pool of the calling thread
+		 */
+		static auto getLocal() -> BufferPool&;
+
+		/**
+		 * Back slabs that are mapped from now on with huge pages. Falls back to transparent
+		 * huge pages and then to regular pages if none are available. Has no effect on
+		 * Windows.
+		 *
+		 * @param bool enable
+		 */
+		static void setUseHugePages(bool enable) noexcept;
+
+		/**
+		 * @param size_t size
+		 *
+		 * @return size_t The size of the block that allocate(size) returns. Equals size if
+		 *                size exceeds MAX_POOLED_SIZE.
+		 */
+		static constexpr auto getBlockSize(size_t size) noexcept -> size_t
+		{
+			for (size_t blockSize : SIZE_CLASSES) {
+				if (size <= blockSize) return blockSize;
+			}
+			return size;
+		}
+
+		BufferPool(const BufferPool&) = delete;
+		BufferPool(BufferPool&&) noexcept = delete;
+		BufferPool& operator=(const BufferPool&) = delete;
+		BufferPool& operator=(BufferPool&&) noexcept = delete;
+
+		/**
+		 * @param size_t size Number of bytes. The block is at least as large and aligned to
+		 *                    __STDCPP_DEFAULT_NEW_ALIGNMENT__.
+		 *
+		 * @return void* Never nullptr
+		 *
+		 * @throw memory_error if no memory can be mapped
+		 */
+		[[nodiscard]]
+		auto allocate(size_t size) -> void*;
+
+		/**
+		 * @param void*  block A block returned by allocate() of any thread's pool
+		 * @param size_t size  The size that has been passed to allocate()
+		 */
+		void deallocate(void* block, size_t size) noexcept;
+
+		[[nodiscard]]
+		auto getStats() const noexcept -> Stats;
+
+	private:
+		static constexpr size_t CLASS_COUNT = SIZE_CLASSES.size();
+		static constexpr size_t BATCH_BYTES = 256 * 1024; // Moved between a pool and the depot at once
+
+		/*
+		A free block stores the pointer to the next one. */
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		struct FreeList
+		{
+			FreeBlock* head{ nullptr };
+			size_t count{ 0 };
+		};
+
+		BufferPool() = default;
+		~BufferPool() noexcept;
+
+		static constexpr auto getClassIndex(size_t size) noexcept -> size_t
+		{
+			size_t i = 0;
+			while (size > SIZE_CLASSES[i]) i++;
+			return i;
+		}
+		static constexpr auto getBatchCount(size_t classIndex) noexcept -> size_t
+		{
+			return BATCH_BYTES / SIZE_CLASSES[classIndex];
+		}
+
+		/**
+		 * Move a batch of blocks from the depot, or from a new slab, to the free list.
+		 *
+		 * @throw memory_error
+		 */
+		void refill(size_t classIndex);
+
+		/**
+		 * Move a batch of blocks from the free list to the depot.
+		 */
+		void release(size_t classIndex, size_t count) noexcept;
+
+		std::array<FreeList, CLASS_COUNT> freeLists;
+		ulong hits{ 0 };
+		ulong misses{ 0 };
+	};
+
+	/* +++ PoolAllocator +++
+	Standard allocator that draws from the calling thread's BufferPool. Stateless; all
+	instances compare equal. */
+	template<typename T>
+	class PoolAllocator
+	{
+		static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+	public:
+		using value_type = T;
+
+		PoolAllocator() noexcept = default;
+		template<typename U>
+		PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+		[[nodiscard]]
+		auto allocate(size_t n) -> T*
+		{
+			return static_cast<T*>(BufferPool::getLocal().allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T* p, size_t n) noexcept
+		{
+			BufferPool::getLocal().deallocate(p, n * sizeof(T));
+		}
+
+		template<typename U>
+		bool operator==(const PoolAllocator<U>&) const noexcept {
+			return true;
+		}
+	};
+
+	using PooledBytes = std::vector<sbyte, PoolAllocator<sbyte>>;
+	using PooledString = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+} // namespace suc
+
+
+
+#endif
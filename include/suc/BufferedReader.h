@@ -0,0 +1,134 @@
+#pragma once
+#ifndef SUCBUFFEREDREADER_H
+#define SUCBUFFEREDREADER_H
+
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+#include "SocketUtility.h"
+#include "BufferPool.h"
+#include "ClientSocket.h"
+
+namespace suc
+{
+	/* +++ BufferedReader +++
+	Reads from a socket through an internal buffer, for protocols that consume their input
+	in lines, headers or fixed-size records.
+
+	Every receive call reads as much as the buffer can hold, so one syscall usually serves
+	many small reads. The results are views into the buffer instead of copies. A view is
+	valid until the next call to a read method of the same reader, which may move the
+	buffered data.
+
+	The buffer grows up to a maximum size, which bounds the length of a record. */
+	class BufferedReader
+	{
+	public:
+		/**
+		 * @param ClientSocket& socket        Must outlive the reader
+		 * @param size_t        maxBufferSize Maximum length of a record, including the
+		 *                                    delimiter
+		 */
+		explicit BufferedReader(ClientSocket& socket, size_t maxBufferSize = DEFAULT_MAX_BUFFER_SIZE);
+
+		BufferedReader(const BufferedReader&) = delete;
+		BufferedReader(BufferedReader&&) noexcept = delete;
+		BufferedReader& operator=(const BufferedReader&) = delete;
+		BufferedReader& operator=(BufferedReader&&) noexcept = delete;
+
+		/**
+		 * Read exactly size bytes.
+		 *
+		 * @param size_t size
+		 * @param int    timeout Time in milliseconds to wait for all bytes, see
+		 *                       ClientSocket::recv().
+		 *
+		 * @return std::optional<std::string_view> Nothing if the timeout has expired or the
+		 *         connection has been closed before enough data arrived, see
+		 *         getLastStatus(). The data received so far stays buffered.
+		 *
+		 * @throw suc_error, or value_error if size exceeds the maximum buffer size
+		 */
+		[[nodiscard]]
+		auto readExact(size_t size, int timeout = TIMEOUT_NEVER) -> std::optional<std::string_view>;
+
+		/**
+		 * Read up to and including the next occurrence of a delimiter, e.g. "\r\n".
+		 *
+		 * @param std::string_view delimiter
+		 * @param int              timeout Time in milliseconds to wait for the delimiter
+		 *
+		 * @return std::optional<std::string_view> The data in front of the delimiter. The
+		 *         delimiter is consumed, but not part of the result. Nothing if the timeout
+		 *         has expired or the connection has been closed, see readExact().
+		 *
+		 * @throw suc_error, or value_error if the maximum buffer size is reached before
+		 *        the delimiter
+		 */
+		[[nodiscard]]
+		auto readUntil(std::string_view delimiter, int timeout = TIMEOUT_NEVER) -> std::optional<std::string_view>;
+
+		/**
+		 * Look at the buffered data without consuming it. Receives data only if nothing is
+		 * buffered.
+		 *
+		 * @param int timeout Time in milliseconds to wait for data if nothing is buffered
+		 *
+		 * @return std::string_view All buffered data. Empty if the timeout has expired or
+		 *         the connection has been closed.
+		 *
+		 * @throw suc_error
+		 */
+		[[nodiscard]]
+		auto peek(int timeout = TIMEOUT_INSTANT) -> std::string_view;
+
+		/**
+		 * Discard buffered data, e.g. after peek().
+		 *
+		 * @param size_t size Is clamped to the buffered size
+		 */
+		void consume(size_t size) noexcept;
+
+		/**
+		 * @return size_t Bytes that have been received but not read yet.
+		 */
+		[[nodiscard]]
+		auto getBufferedSize() const noexcept -> size_t;
+
+		/**
+		 * @return RecvStatus The result of the last receive call. Distinguishes closed
+		 *         connections from timeouts after a read has returned nothing.
+		 */
+		[[nodiscard]]
+		auto getLastStatus() const noexcept -> RecvStatus;
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		static constexpr size_t INITIAL_BUFFER_SIZE = 4 * 1024;
+		static constexpr size_t DEFAULT_MAX_BUFFER_SIZE = 1024 * 1024;
+
+		/**
+		 * Receive once, after making room for at least required unread bytes.
+		 *
+		 * @param clock::time_point deadline time_point::max() to wait without a limit
+		 *
+		 * @return bool True if data has been received
+		 */
+		bool fill(size_t required, clock::time_point deadline);
+		auto getUnread() const noexcept -> std::string_view;
+
+		ClientSocket& socket;
+		const size_t maxBufferSize;
+
+		PooledBytes buffer;
+		size_t begin{ 0 };	// First unread byte
+		size_t end{ 0 };	// Behind the last received byte
+		RecvStatus lastStatus{ RecvStatus::OK };
+	};
+} // namespace suc
+
+
+
+#endif
@@ -0,0 +1,269 @@
+#pragma once
+#ifndef SUCBYTEBUFFER_H
+#define SUCBYTEBUFFER_H
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "SocketUtility.h"
+
+namespace suc
+{
+	template<typename T>
+	using IsPtr = std::enable_if_t<std::is_pointer_v<T>>;
+
+	using buf_size = size_t;
+	using buf_offset = size_t;
+
+	/* +++ ByteBuffer +++
+	An abstraction for a piece of memory.
+	Access the memory through casts to any type. Implicit casts are not allowed, except
+	the implicit cast to (void*).
+
+	The memory is a chain of reference-counted segments drawn from the thread's BufferPool.
+	Copies and slices share the segments instead of copying the bytes, and appending
+	another buffer links its segments into the chain. The chain is copied into a single
+	segment only when contiguous memory is requested through a cast or data().
+
+	Shared memory must not be written through a pointer; call unshare() first. The
+	methods that write to the buffer do so themselves. */
+	class ByteBuffer
+	{
+	public:
+		/* +++ Overloaded constructor +++
+		Creates a zero-initializes buffer.
+		- ARG size: The buffer's storage size in bytes. */
+		explicit ByteBuffer(buf_size size = 0U);
+
+		/* +++ Overloaded constructor +++
+		Creates a buffer from a source buffer.
+		- ARG size: The buffer's storage size in bytes. Must match the size of buffer.
+		- ARG buffer: The contents of this buffer will be copied into the new ByteBuffer.
+		The memory on this buffer will not be freed. */
+		ByteBuffer(buf_size size, const void* source);
+
+		/* +++ create() +++
+		Creates an empty buffer with preallocated room.
+		- ARG capacity: Bytes that can be appended without allocating.
+		- ARG headroom: Bytes that can be prepended without allocating, e.g. for a header
+		that is only known once the body has been written. */
+		[[nodiscard]] static auto create(buf_size capacity, buf_size headroom = 0U) -> ByteBuffer;
+
+		/* +++ Copy constructor +++
+		Shares the other's memory.
+		Does not modify the other buffer. */
+		ByteBuffer(const ByteBuffer& other);
+		/* +++ Copy assignment +++
+		Shares the other's memory.
+		Does not modify the other buffer. */
+		ByteBuffer& operator=(const ByteBuffer& rhs);
+		/* +++ Move constructor +++
+		Takes the other's memory.
+		Invalidates the other buffer. */
+		ByteBuffer(ByteBuffer&& other) noexcept;
+		/* +++ Move assignment +++
+		Takes the other's memory.
+		Invalidates the other buffer. */
+		ByteBuffer& operator=(ByteBuffer&& rhs) noexcept;
+
+		/* +++ Destructor +++
+		Frees memory that is not shared with other buffers. */
+		~ByteBuffer() noexcept;
+
+		/* explicit cast operator */
+		template<typename T, IsPtr<T>...>
+		explicit inline operator T() const {
+			return static_cast<T> (data());
+		}
+
+		/* implicit cast to void* */
+		inline operator void* () const {
+			return data();
+		}
+
+		/* +++ Explicit cast operator +++
+		Casts the buffer's contents to any type.
+		RETURN: Returns a pointer to the raw data. */
+		template<typename T, IsPtr<T>...>
+		[[nodiscard]] inline T to() const {
+			return static_cast<T> (data());
+		}
+
+		/* size */
+		[[nodiscard]] inline buf_size size() const {
+			return _size;
+		}
+
+		/* +++ data() +++
+		Coalesces the chain if it has more than one segment. Not thread-safe, not even on
+		const buffers.
+		- RETURN: Returns a pointer to the contiguous contents, nullptr if the buffer is
+		empty. */
+		[[nodiscard]] void* data() const;
+
+		/* +++ cpy() +++
+		Performs a memcpy from a buffer to the ByteBuffer.
+		Unshares and coalesces the buffer first.
+		- ARG source: The source buffer
+		- ARG offset: The offset into the ByteBuffer.
+		- ARG size: The size of the copied memory in bytes.
+		- RETURN: Returns this buffer. */
+		ByteBuffer& cpy(const void* source, buf_offset offset, buf_size size);
+
+		/* create a copy that does not share memory */
+		[[nodiscard]] ByteBuffer makeCopy() const;
+
+		/* create a copy and return raw data pointer */
+		[[nodiscard]] void* makeRawCopy() const;
+
+		/* create a copy from a range that does not share memory */
+		[[nodiscard]] ByteBuffer makeCopyRange(buf_offset offset, buf_size size) const;
+
+		/* create a copy from a range and return raw data pointer */
+		[[nodiscard]] void* makeRawCopyRange(buf_offset offset, buf_size size) const;
+
+		/* +++ copyTo() +++
+		Copies a range of the buffer to other memory without coalescing the chain.
+		- ARG offset: The offset into the ByteBuffer.
+		- ARG size: The size of the copied memory in bytes.
+		- ARG dest: Receives size bytes. */
+		void copyTo(buf_offset offset, buf_size size, void* dest) const;
+
+		/* +++ find() +++
+		Searches for a byte sequence, also across segment boundaries.
+		- ARG pattern: The sequence to search for.
+		- ARG from: The offset at which the search starts.
+		- RETURN: Returns the offset of the first occurrence, or nothing. */
+		[[nodiscard]] auto find(std::string_view pattern, buf_offset from = 0U) const -> std::optional<buf_offset>;
+
+		/* +++ resize() +++
+		Resizes the buffer. All contents will be discarded. */
+		void resize(buf_size size);
+
+		/* +++ slice() +++
+		Creates a buffer that shares a range of this buffer's memory. Does not copy.
+		- ARG offset: The offset into the ByteBuffer.
+		- ARG size: The size of the range in bytes.
+		- RETURN: Returns the new buffer. */
+		[[nodiscard]] auto slice(buf_offset offset, buf_size size) const -> ByteBuffer;
+
+		/* +++ trimStart() / trimEnd() +++
+		Removes bytes from the front or the back, e.g. after they have been parsed.
+		Does not copy. */
+		void trimStart(buf_size size);
+		void trimEnd(buf_size size);
+
+		/* +++ prepend() +++
+		Copies data to the front of the buffer. Writes into the headroom if possible,
+		otherwise links a new segment into the chain. */
+		void prepend(const void* source, buf_size size);
+
+		/* +++ append() +++
+		Copies data to the back of the buffer. Writes into the tailroom if possible,
+		otherwise links a new segment into the chain. */
+		void append(const void* source, buf_size size);
+
+		/* +++ append() +++
+		Links the other buffer's segments into the chain. Does not copy. */
+		void append(ByteBuffer other);
+
+		/* +++ preallocate() +++
+		Provides writable memory at the back of the buffer, e.g. to receive into.
+		Call postallocate() with the number of bytes that have been written to it.
+		- ARG minSize: The returned memory is at least this large.
+		- RETURN: Returns all writable memory behind the last byte. */
+		[[nodiscard]] auto preallocate(buf_size minSize) -> std::span<std::byte>;
+
+		/* +++ postallocate() +++
+		Appends bytes that have been written to the memory returned by preallocate(). */
+		void postallocate(buf_size size);
+
+		/* +++ coalesce() +++
+		Copies the chain into a single segment. Does not change the contents.
+		Not thread-safe, not even on const buffers. */
+		void coalesce() const;
+
+		/* +++ unshare() +++
+		Copies the contents into memory that is not shared with other buffers. */
+		void unshare();
+
+		/* true if any memory is shared with another buffer */
+		[[nodiscard]] bool isShared() const;
+
+		/* true if the buffer has more than one segment */
+		[[nodiscard]] bool isChained() const;
+
+		[[nodiscard]] auto getSegmentCount() const -> size_t;
+
+		/* Bytes that prepend() can write without allocating if the buffer is not shared */
+		[[nodiscard]] auto getHeadroom() const -> buf_size;
+
+		/* Bytes that append() can write without allocating if the buffer is not shared */
+		[[nodiscard]] auto getTailroom() const -> buf_size;
+
+		/* +++ getSegments() +++
+		- RETURN: Returns the non-empty segments in order, e.g. for vectored I/O. */
+		[[nodiscard]] auto getSegments() const -> std::vector<iovec>;
+
+	private:
+		/*
+		Header of a pooled block, followed by the memory. */
+		struct Storage;
+
+		/*
+		A range of a storage block. Holds one reference to the storage. */
+		struct Segment
+		{
+			Storage* storage;
+			sbyte* begin;
+			buf_size length;
+
+			[[nodiscard]] auto headroom() const -> buf_size;
+			[[nodiscard]] auto tailroom() const -> buf_size;
+			[[nodiscard]] bool isShared() const;
+		};
+
+		static auto allocateStorage(buf_size capacity) -> Storage*;
+		static void acquire(Storage* storage) noexcept;
+		static void release(Storage* storage) noexcept;
+
+		/* Adds a segment of at least capacity bytes behind headroom bytes. */
+		auto appendSegment(buf_size capacity, buf_size headroom) -> Segment&;
+		bool matchesAt(size_t segmentIndex, const sbyte* pos, std::string_view pattern) const;
+		void checkRange(buf_offset offset, buf_size size) const;
+		void clear() noexcept;
+
+		buf_size _size{ 0U };
+		mutable std::vector<Segment> segments;
+	};
+
+
+
+	inline bool operator<(const ByteBuffer& lhs, const ByteBuffer& rhs) {
+		return lhs.size() < rhs.size();
+	}
+	inline bool operator>(const ByteBuffer& lhs, const ByteBuffer& rhs) {
+		return lhs.size() > rhs.size();
+	}
+	inline bool operator<=(const ByteBuffer& lhs, const ByteBuffer& rhs) {
+		return lhs.size() <= rhs.size();
+	}
+	inline bool operator>=(const ByteBuffer& lhs, const ByteBuffer& rhs) {
+		return lhs.size() >= rhs.size();
+	}
+	inline bool operator==(const ByteBuffer& lhs, const ByteBuffer& rhs) {
+		return lhs.size() == rhs.size();
+	}
+
+
+
+	void THROW_FAILED_MEM_ALLOC(size_t size);
+} // namespace suc
+
+
+
+#endif
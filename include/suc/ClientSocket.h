@@ -1,12 +1,33 @@
 #ifndef CLIENTSOCKET_H
 #define CLIENTSOCKET_H
 
+#include <chrono>
+#include <cstddef>
+#include <span>
 #include <string>
 
 #include "SocketUtility.h"
+#include "AdaptiveBufferSizer.h"
+#include "BufferPool.h"
+#include "Coroutine.h"
 
 namespace suc
 {
+	class ByteBuffer;
+
+	enum class RecvStatus
+	{
+		OK,			// Data has been received
+		TIMEOUT,	// No data arrived within the timeout
+		CLOSED,		// The peer has closed the connection
+	};
+
+	struct RecvResult
+	{
+		size_t bytes;
+		RecvStatus status;
+	};
+
 	class ClientSocket
 	{
 	public:
@@ -41,9 +62,35 @@ namespace suc
 		 */
 		bool connect(std::string ip, int port, int family = IPV4);
 
+		/**
+		 * Attempt to connect to a remote server within a deadline.
+		 * 
+		 * Races the resolved addresses against each other as described in RFC 8305 (Happy
+		 * Eyeballs): addresses of both families are interleaved, a new attempt is started
+		 * whenever the previous one has neither succeeded nor failed within attemptDelay, and
+		 * the first connection that succeeds is kept. Use IPVX to race IPv4 against IPv6.
+		 * 
+		 * @param std::string ip           The server's IP address or host name
+		 * @param int         port         The server's port
+		 * @param int         family       IPV4, IPV6 or IPVX
+		 * @param std::chrono::milliseconds timeout      Deadline for the whole operation
+		 * @param std::chrono::milliseconds attemptDelay Head start of each attempt before the
+		 *                                               next one is started
+		 * 
+		 * @return bool True if a connection was established, false if the deadline expired.
+		 * 
+		 * @throw suc_error if all addresses have failed before the deadline
+		 */
+		bool connect(std::string ip, int port, int family,
+					 std::chrono::milliseconds timeout,
+					 std::chrono::milliseconds attemptDelay = DEFAULT_CONNECT_ATTEMPT_DELAY);
+
 		/**
 		 * Send data through the socket. This is the classic c-style signature version.
 		 * 
+		 * Blocks until all data has been handed to the kernel. Use an OutboundQueue to
+		 * send without blocking.
+		 * 
 		 * @param const void* buf  The data to be sent
 		 * @param size_t 	  size The size of the buffer
 		 * 
@@ -69,6 +116,40 @@ namespace suc
 		 */
 		void send(const std::string& str);
 
+		/**
+		 * Send several buffers through the socket as if they were one, e.g. the head and the
+		 * body of a message. Avoids copying them into a single staging buffer and usually
+		 * takes a single syscall.
+		 * 
+		 * @param std::span<const iovec> buffers
+		 * 
+		 * @throw suc_error
+		 */
+		void send(std::span<const iovec> buffers);
+
+		/**
+		 * Send a buffer chain. The segments are sent directly, without coalescing them.
+		 * 
+		 * @param const ByteBuffer& buf
+		 * 
+		 * @throw suc_error
+		 */
+		void send(const ByteBuffer& buf);
+
+		/**
+		 * Send a range of a file through the socket. On Linux, the kernel copies the data
+		 * directly from the page cache with sendfile(2), so it never passes through user
+		 * space.
+		 * 
+		 * @param int    fd     A file descriptor opened for reading. The file position is
+		 *                      not changed.
+		 * @param ulong  offset Position of the first byte to send
+		 * @param size_t length Number of bytes to send
+		 * 
+		 * @throw suc_error, or value_error if the file ends before offset + length
+		 */
+		void sendFile(int fd, ulong offset, size_t length);
+
 		/**
 		 * Read data from the socket.
 
@@ -77,7 +158,7 @@ namespace suc
 		 * If the timeout parameter is set to -1, the method will block until data is available.
 
 		 * @return std::vector<sbyte> The received data. Is empty if the timeout has expired and no data has been
-		 * received.
+		 * received, or if the connection has been closed remotely.
 		 * 
 		 * @throw suc_error
 		 */
@@ -99,6 +180,90 @@ namespace suc
 		[[nodiscard]]
 		auto recvString(int timeout = TIMEOUT_NEVER) -> std::string;
 
+		/**
+		 * Read data into a caller-provided buffer. Does not allocate.
+		 * 
+		 * @param std::span<std::byte> buf     Receives at most buf.size() bytes
+		 * @param int                  timeout Time in milliseconds to wait for data, see recv().
+		 * 
+		 * @return RecvResult The number of bytes read, which is only non-zero if the status
+		 *         is RecvStatus::OK.
+		 * 
+		 * @throw suc_error
+		 */
+		[[nodiscard]]
+		auto recvInto(std::span<std::byte> buf, int timeout = TIMEOUT_NEVER) -> RecvResult;
+
+		/**
+		 * Read all available data into a string, replacing its contents. The string's
+		 * capacity is reused, so once it has grown to fit the largest message, receiving
+		 * does not allocate.
+		 * 
+		 * @param std::string& str     Receives the data
+		 * @param int          timeout Time in milliseconds to wait for data, see recv().
+		 * 
+		 * @return RecvResult The number of bytes read, which equals str.size().
+		 * 
+		 * @throw suc_error
+		 */
+		auto recvString(std::string& str, int timeout = TIMEOUT_NEVER) -> RecvResult;
+
+		/**
+		 * Read all available data into a buffer from the thread's BufferPool, replacing
+		 * its contents. Like recvString(std::string&), the buffer's capacity is reused.
+		 * 
+		 * @param PooledBytes& buf     Receives the data
+		 * @param int          timeout Time in milliseconds to wait for data, see recv().
+		 * 
+		 * @return RecvResult The number of bytes read, which equals buf.size().
+		 * 
+		 * @throw suc_error
+		 */
+		auto recv(PooledBytes& buf, int timeout = TIMEOUT_NEVER) -> RecvResult;
+
+		/**
+		 * Read all available data and append it to a buffer chain. Received data is
+		 * never moved: the chain grows by new segments from the thread's BufferPool, so
+		 * slices of earlier data stay valid and can be sent on without copying.
+		 * 
+		 * @param ByteBuffer& buf     Receives the data
+		 * @param int         timeout Time in milliseconds to wait for data, see recv().
+		 * 
+		 * @return RecvResult The number of bytes that have been appended.
+		 * 
+		 * @throw suc_error
+		 */
+		auto recv(ByteBuffer& buf, int timeout = TIMEOUT_NEVER) -> RecvResult;
+
+		/**
+		 * Read data from the socket inside a coroutine.
+		 * 
+		 * The calling coroutine is suspended until data is available and resumed by the
+		 * calling thread's current EventLoop (see EventLoop::getCurrent()).
+		 * 
+		 * @param std::span<sbyte> buf Receives the data. Must stay valid until resumed.
+		 * 
+		 * @return RecvAwaitable Yields the number of bytes read when awaited. 0 means
+		 * that the connection has been closed remotely.
+		 * 
+		 * @throw suc_error when awaited
+		 */
+		[[nodiscard]]
+		auto asyncRecv(std::span<sbyte> buf) -> RecvAwaitable;
+
+		/**
+		 * Send data through the socket inside a coroutine.
+		 * 
+		 * The calling coroutine is suspended while the socket's send buffer is full and
+		 * resumed by the calling thread's current EventLoop once all data has been sent.
+		 * 
+		 * @param std::span<const sbyte> data Must stay valid until resumed.
+		 * 
+		 * @throw suc_error when awaited
+		 */
+		[[nodiscard]]
+		auto asyncSend(std::span<const sbyte> data) -> SendAwaitable;
+
 		/**
 		 * Tests if the socket has data ready to read.
 		 * 
@@ -130,11 +295,36 @@ namespace suc
 		[[nodiscard]]
 		bool isClosed() const noexcept;
 
+		/**
+		 * Get the predictor that chooses the buffer size of recv() and recvString() from
+		 * the sizes of this connection's recent messages. Can be replaced to change its
+		 * limits.
+		 *
+		 * @return AdaptiveBufferSizer&
+		 */
+		[[nodiscard]]
+		auto getRecvBufferSizer() noexcept -> AdaptiveBufferSizer&;
+
+		/**
+		 * Access the underlying socket descriptor, e.g. to register it with an EventLoop.
+		 *
+		 * @return SOCKET The native descriptor. INVALID_SOCKET if the socket has never been opened.
+		 */
+		[[nodiscard]]
+		auto getNativeHandle() const noexcept -> SOCKET;
+
 	private:
-		static constexpr size_t STANDARD_BUF_SIZE = 4096;
+		// Recommended value from RFC 8305, section 5
+		static constexpr std::chrono::milliseconds DEFAULT_CONNECT_ATTEMPT_DELAY{ 250 };
+
+		/**
+		 * Block until a non-blocking socket can take more data.
+		 */
+		void waitUntilWritable() const;
 
 		SOCKET socket{ INVALID_SOCKET };
 		bool _isClosed{ true };
+		AdaptiveBufferSizer recvBufferSizer;
 	};
 } // namespace suc
 
@@ -0,0 +1,178 @@
+#pragma once
+#ifndef SUCCONNECTIONPOOL_H
+#define SUCCONNECTIONPOOL_H
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SocketUtility.h"
+#include "ClientSocket.h"
+
+namespace suc
+{
+	struct ConnectionPoolOptions
+	{
+		size_t maxIdlePerEndpoint{ 8 };	// Further returned connections are closed
+		size_t maxTotal{ 64 };			// Idle and checked out connections of all endpoints
+		std::chrono::milliseconds idleTimeout{ std::chrono::seconds(60) };
+	};
+
+	/* +++ ConnectionPool +++
+	Keeps idle client connections per endpoint (host, port, family) so that requests to the
+	same upstream reuse an established connection instead of paying for name resolution, a
+	handshake and slow start every time.
+
+	checkout() hands out the most recently returned connection that passes a health check.
+	A connection is considered broken if it is readable while idle, which means that the
+	peer has closed it or sent data that nobody asked for.
+
+	Thread-safe. The pool must outlive all connections that are checked out from it. */
+	class ConnectionPool
+	{
+	public:
+		class Connection;
+
+		struct Stats
+		{
+			size_t idle;
+			size_t active;		// Checked out
+			ulong reused;
+			ulong created;
+			ulong discarded;	// Closed by health checks, idle eviction or limits
+		};
+
+		explicit ConnectionPool(ConnectionPoolOptions options = {});
+
+		ConnectionPool(const ConnectionPool&) = delete;
+		ConnectionPool(ConnectionPool&&) noexcept = delete;
+		ConnectionPool& operator=(const ConnectionPool&) = delete;
+		ConnectionPool& operator=(ConnectionPool&&) noexcept = delete;
+
+		/**
+		 * Get a connection to an endpoint. Reuses an idle connection if a healthy one
+		 * exists, otherwise connects a new socket.
+		 *
+		 * If the pool is at its total limit, the least recently used idle connection of any
+		 * endpoint is closed to make room.
+		 *
+		 * @param std::string host   Host name or IP address
+		 * @param int         port
+		 * @param int         family IPV4, IPV6 or IPVX
+		 *
+		 * @return Connection Returns the socket to the pool when destroyed.
+		 *
+		 * @throw runtime_error if the total limit is reached and no connection is idle
+		 * @throw suc_error if a new connection cannot be established
+		 */
+		[[nodiscard]]
+		auto checkout(const std::string& host, int port, int family = IPV4) -> Connection;
+
+		/**
+		 * Close all connections that have been idle for longer than the idle timeout.
+		 * This also happens on every checkout() and return, so calling it is only
+		 * necessary to release connections of endpoints that are no longer used.
+		 */
+		void evictIdle();
+
+		/**
+		 * Close all idle connections.
+		 */
+		void clear();
+
+		[[nodiscard]]
+		auto getStats() const -> Stats;
+
+		/* +++ Connection +++
+		A checked out connection. Returns the socket to its pool on destruction unless it
+		has been closed or discarded. */
+		class Connection
+		{
+		public:
+			Connection(const Connection&) = delete;
+			Connection(Connection&& other) noexcept;
+			~Connection() noexcept;
+
+			Connection& operator=(const Connection&) = delete;
+			Connection& operator=(Connection&& rhs) noexcept;
+
+			auto operator*() noexcept -> ClientSocket& { return socket; }
+			auto operator->() noexcept -> ClientSocket* { return &socket; }
+
+			/**
+			 * Close the socket instead of returning it to the pool, e.g. after an error left
+			 * the protocol in an unknown state.
+			 */
+			void discard();
+
+			/**
+			 * @return bool True if the connection was taken from the pool, false if it has
+			 *              been connected by the checkout. A reused connection may still
+			 *              have been closed by the peer in the meantime.
+			 */
+			[[nodiscard]]
+			bool isReused() const noexcept;
+
+		private:
+			friend ConnectionPool;
+			Connection(ConnectionPool& pool, size_t endpoint, ClientSocket socket, bool reused) noexcept;
+
+			ConnectionPool* pool;
+			size_t endpoint;
+			ClientSocket socket;
+			bool reused;
+		};
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		struct Endpoint
+		{
+			std::string host;
+			int port;
+			int family;
+
+			bool operator==(const Endpoint&) const = default;
+		};
+
+		struct EndpointHash
+		{
+			auto operator()(const Endpoint& endpoint) const noexcept -> size_t;
+		};
+
+		struct IdleConnection
+		{
+			ClientSocket socket;
+			clock::time_point since;
+		};
+
+		/**
+		 * Called by Connection when it is destroyed.
+		 */
+		void giveBack(size_t endpoint, ClientSocket socket) noexcept;
+
+		/**
+		 * @return bool True if an idle connection has been closed. Requires the lock.
+		 */
+		bool closeLeastRecentlyUsed();
+		void evictIdleLocked(clock::time_point now);
+
+		const ConnectionPoolOptions options;
+
+		mutable std::mutex mutex;
+		std::unordered_map<Endpoint, size_t, EndpointHash> endpointIndices;
+		std::vector<std::deque<IdleConnection>> idleConnections; // Oldest first, per endpoint
+		size_t idleCount{ 0 };
+		size_t activeCount{ 0 };
+		ulong reused{ 0 };
+		ulong created{ 0 };
+		ulong discarded{ 0 };
+	};
+} // namespace suc
+
+
+
+#endif
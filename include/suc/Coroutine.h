@@ -0,0 +1,223 @@
+#pragma once
+#ifndef SUCCOROUTINE_H
+#define SUCCOROUTINE_H
+
+#include <coroutine>
+#include <exception>
+#include <span>
+#include <utility>
+#include <variant>
+
+#include "SocketUtility.h"
+#include "EventLoop.h"
+
+namespace suc
+{
+	class ClientSocket;
+
+	/* +++ Task +++
+	The return type of coroutines that use the awaitable socket operations.
+
+	A task starts suspended and runs when it is awaited by another task or passed to
+	spawn(). Awaiting a task yields its return value or rethrows its exception. */
+	template<typename T = void>
+	class Task;
+
+	namespace detail
+	{
+		template<typename T>
+		struct TaskPromiseBase
+		{
+			std::coroutine_handle<> continuation{ std::noop_coroutine() };
+
+			struct FinalAwaiter
+			{
+				bool await_ready() const noexcept { return false; }
+
+				template<typename Promise>
+				auto await_suspend(std::coroutine_handle<Promise> handle) const noexcept -> std::coroutine_handle<>
+				{
+					return handle.promise().continuation;
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			auto initial_suspend() const noexcept -> std::suspend_always { return {}; }
+			auto final_suspend() const noexcept -> FinalAwaiter { return {}; }
+		};
+
+		template<typename T>
+		struct TaskPromise : TaskPromiseBase<T>
+		{
+			std::variant<std::monostate, T, std::exception_ptr> result;
+
+			auto get_return_object() noexcept -> Task<T>;
+
+			template<typename U>
+			void return_value(U&& value) { result.template emplace<1>(std::forward<U>(value)); }
+			void unhandled_exception() noexcept { result.template emplace<2>(std::current_exception()); }
+
+			auto getResult() -> T
+			{
+				if (result.index() == 2) {
+					std::rethrow_exception(std::get<2>(result));
+				}
+				return std::move(std::get<1>(result));
+			}
+		};
+
+		template<>
+		struct TaskPromise<void> : TaskPromiseBase<void>
+		{
+			std::exception_ptr exception;
+
+			auto get_return_object() noexcept -> Task<void>;
+
+			void return_void() const noexcept {}
+			void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+			void getResult() const
+			{
+				if (exception) {
+					std::rethrow_exception(exception);
+				}
+			}
+		};
+	} // namespace detail
+
+	template<typename T>
+	class Task
+	{
+	public:
+		using promise_type = detail::TaskPromise<T>;
+
+		explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle(handle) {}
+		Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+		~Task() noexcept
+		{
+			if (handle) handle.destroy();
+		}
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+		Task& operator=(Task&& rhs) noexcept
+		{
+			std::swap(handle, rhs.handle);
+			return *this;
+		}
+
+		auto operator co_await() && noexcept
+		{
+			struct Awaiter
+			{
+				std::coroutine_handle<promise_type> handle;
+
+				bool await_ready() const noexcept { return false; }
+
+				auto await_suspend(std::coroutine_handle<> awaiting) const noexcept -> std::coroutine_handle<>
+				{
+					handle.promise().continuation = awaiting;
+					return handle;
+				}
+
+				auto await_resume() const -> T
+				{
+					return handle.promise().getResult();
+				}
+			};
+
+			return Awaiter{ handle };
+		}
+
+	private:
+		std::coroutine_handle<promise_type> handle;
+	};
+
+	template<typename T>
+	inline auto detail::TaskPromise<T>::get_return_object() noexcept -> Task<T>
+	{
+		return Task<T>{ std::coroutine_handle<TaskPromise<T>>::from_promise(*this) };
+	}
+
+	inline auto detail::TaskPromise<void>::get_return_object() noexcept -> Task<void>
+	{
+		return Task<void>{ std::coroutine_handle<TaskPromise<void>>::from_promise(*this) };
+	}
+
+	/**
+	 * Run a task without awaiting it. The task starts immediately on the calling thread and
+	 * continues on the thread of the event loop that resumes it. Its frame is destroyed when
+	 * it completes. Exceptions that escape the task are printed to std::cerr.
+	 */
+	void spawn(Task<void> task);
+
+
+	// ---------------------------- //
+	//		Socket awaitables		//
+	// ---------------------------- //
+
+	/*
+	Awaitable returned by ClientSocket::asyncRecv(). Resumes with the number of bytes read,
+	which is 0 if the peer has closed the connection. */
+	class RecvAwaitable : EventLoop::Waiter
+	{
+	public:
+		RecvAwaitable(SOCKET socket, std::span<sbyte> buf) noexcept;
+
+		bool await_ready();
+		void await_suspend(std::coroutine_handle<> awaiting);
+		auto await_resume() -> size_t;
+
+	private:
+		bool tryRecv();
+
+		std::span<sbyte> buf;
+		std::coroutine_handle<> awaiting;
+		int result{ 0 };
+	};
+
+	/*
+	Awaitable returned by ClientSocket::asyncSend(). Resumes when all data has been handed to
+	the kernel, waiting for writability as often as necessary. */
+	class SendAwaitable : EventLoop::Waiter
+	{
+	public:
+		SendAwaitable(SOCKET socket, std::span<const sbyte> data) noexcept;
+
+		bool await_ready();
+		void await_suspend(std::coroutine_handle<> awaiting);
+		void await_resume();
+
+	private:
+		bool trySend();
+
+		std::span<const sbyte> remaining;
+		std::coroutine_handle<> awaiting;
+		int lastError{ 0 };
+	};
+
+	/*
+	Awaitable returned by ServerSocket::asyncAccept(). Resumes with the new connection, which
+	is non-blocking. Waits again if another thread has taken the connection that woke it up. */
+	class AcceptAwaitable : EventLoop::Waiter
+	{
+	public:
+		explicit AcceptAwaitable(SOCKET listener) noexcept;
+
+		bool await_ready();
+		void await_suspend(std::coroutine_handle<> awaiting);
+		auto await_resume() -> ClientSocket;
+
+	private:
+		bool tryAccept();
+
+		std::coroutine_handle<> awaiting;
+		SOCKET accepted{ INVALID_SOCKET };
+		int lastError{ 0 };
+	};
+} // namespace suc
+
+
+
+#endif
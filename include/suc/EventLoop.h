@@ -0,0 +1,219 @@
+#pragma once
+#ifndef SUCEVENTLOOP_H
+#define SUCEVENTLOOP_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "SocketUtility.h"
+#include "TimerWheel.h"
+
+#ifdef OS_IS_LINUX
+	#include <sys/epoll.h>
+#endif
+
+namespace suc
+{
+	class ClientSocket;
+	class ServerSocket;
+
+	/* +++ EventLoop +++
+	Waits for readiness events on an arbitrary number of socket descriptors and dispatches
+	them to per-descriptor handlers. Backed by epoll, so the cost of one wakeup depends only
+	on the number of ready descriptors and there is no FD_SETSIZE limit.
+
+	Every loop has a TimerWheel for timeouts and deadlines. poll() does not wait past the
+	next expiry and fires expired timers after the descriptor events.
+
+	Registration and polling must happen on the same thread. Only post() and stop() may be
+	called from other threads. */
+	class EventLoop
+	{
+	public:
+		using event_flags = uint;
+
+		static constexpr event_flags READABLE		= 1U << 0;
+		static constexpr event_flags WRITABLE		= 1U << 1;
+		static constexpr event_flags HANGUP			= 1U << 2; // Peer closed its end
+		static constexpr event_flags ERROR			= 1U << 3;
+		static constexpr event_flags EDGE_TRIGGERED = 1U << 4; // Registration only
+
+		/**
+		 * Called with the set of events that occured on the descriptor.
+		 */
+		using Handler = std::function<void(event_flags)>;
+
+		/* +++ Waiter +++
+		A one-shot registration that does not allocate. It is usually embedded in the object
+		that waits, e.g. a coroutine awaiter. The waiter must stay alive until it has fired. */
+		struct Waiter
+		{
+			using Callback = void(*)(Waiter&, event_flags);
+
+			SOCKET socket{ INVALID_SOCKET };
+			event_flags events{ 0 };
+			Callback onReady{ nullptr };
+		};
+
+		/**
+		 * @param int maxEventsPerPoll The maximum number of events dispatched by one call
+		 *                             to poll().
+		 *
+		 * @throw suc_error
+		 */
+		explicit EventLoop(int maxEventsPerPoll = DEFAULT_MAX_EVENTS);
+		~EventLoop() noexcept;
+
+		EventLoop(const EventLoop&) = delete;
+		EventLoop(EventLoop&&) noexcept = delete;
+		EventLoop& operator=(const EventLoop&) = delete;
+		EventLoop& operator=(EventLoop&&) noexcept = delete;
+
+		/**
+		 * Register a descriptor with the loop.
+		 *
+		 * The loop does not take ownership of the descriptor. Remove it before closing it.
+		 *
+		 * @param SOCKET      socket  The descriptor to watch
+		 * @param event_flags events  Any combination of READABLE, WRITABLE and EDGE_TRIGGERED.
+		 *                            HANGUP and ERROR are always reported.
+		 * @param Handler     handler Called from poll() when the descriptor is ready
+		 *
+		 * @throw suc_error if the descriptor is invalid or already registered
+		 */
+		void add(SOCKET socket, event_flags events, Handler handler);
+		void add(const ClientSocket& socket, event_flags events, Handler handler);
+		void add(const ServerSocket& socket, event_flags events, Handler handler);
+
+		/**
+		 * Change the set of events that a registered descriptor is watched for.
+		 *
+		 * @throw suc_error
+		 */
+		void modify(SOCKET socket, event_flags events);
+
+		/**
+		 * Unregister a descriptor. Does nothing if the descriptor is not registered.
+		 *
+		 * It is safe to call this from within a handler, including the descriptor's own.
+		 */
+		void remove(SOCKET socket) noexcept;
+
+		/**
+		 * Wait once for the waiter's events on its socket. The waiter is disarmed before
+		 * Waiter::onReady is invoked, which may call wait() again to re-arm.
+		 *
+		 * If the socket is registered with add(), the waiter is attached to the registration
+		 * and its events are watched in addition to the registration's. A registration can
+		 * have one waiter at a time. Removing the registration drops its waiter.
+		 *
+		 * @throw suc_error
+		 */
+		void wait(Waiter& waiter);
+
+		/**
+		 * Disarm a waiter that has not fired yet. Does nothing if the waiter is not armed.
+		 */
+		void cancel(Waiter& waiter) noexcept;
+
+		/**
+		 * Run a function on the loop's thread, from within the next poll(). Other threads
+		 * use this to register descriptors or schedule timers. Wakes up a blocking poll().
+		 *
+		 * Functions that have not run when the loop is destroyed are discarded.
+		 *
+		 * Thread-safe.
+		 */
+		void post(std::function<void()> task);
+
+		/**
+		 * Get the loop's timers, e.g. to schedule the idle timeout of a connection.
+		 *
+		 * @return TimerWheel& Advanced by poll().
+		 */
+		[[nodiscard]]
+		auto getTimers() noexcept -> TimerWheel&;
+
+		[[nodiscard]]
+		bool contains(SOCKET socket) const noexcept;
+
+		/**
+		 * @return size_t The number of registered descriptors.
+		 */
+		[[nodiscard]]
+		auto size() const noexcept -> size_t;
+
+		/**
+		 * Wait for events and dispatch them to their handlers.
+		 *
+		 * @param int timeout Time in milliseconds to wait for events. TIMEOUT_NEVER blocks
+		 *                    until at least one event occurs, a timer expires or stop()
+		 *                    is called.
+		 *
+		 * @return size_t The number of handlers, posted functions and timers that have
+		 *                been invoked.
+		 *
+		 * @throw suc_error; exceptions thrown by handlers are propagated
+		 */
+		auto poll(int timeout = TIMEOUT_NEVER) -> size_t;
+
+		/**
+		 * Calls poll() repeatedly until stop() is called.
+		 *
+		 * @throw suc_error
+		 */
+		void run();
+
+		/**
+		 * Makes run() return after the current iteration. Wakes up a blocking poll().
+		 *
+		 * Thread-safe.
+		 */
+		void stop() noexcept;
+
+		/**
+		 * Get the event loop that the calling thread currently runs.
+		 *
+		 * A loop becomes the current loop of the thread that creates it, unless that thread
+		 * already has one, and of every thread that calls its poll() or run().
+		 *
+		 * @throw suc_error if the thread has no current event loop
+		 */
+		[[nodiscard]]
+		static auto getCurrent() -> EventLoop&;
+
+	private:
+		static constexpr int DEFAULT_MAX_EVENTS = 256;
+
+		struct Registration
+		{
+			Handler handler;
+			event_flags events;
+			Waiter* waiter{ nullptr };
+		};
+
+		void updateInterest(SOCKET socket, const Registration& registration);
+		auto runPosted() -> size_t;
+
+		SOCKET epollFd{ INVALID_SOCKET };
+		int wakeupFd{ -1 };
+		std::atomic<bool> shouldStop{ false };
+
+		std::mutex postedMutex;
+		std::vector<std::function<void()>> posted;
+
+		std::unordered_map<SOCKET, std::shared_ptr<Registration>> registrations;
+		TimerWheel timers;
+#ifdef OS_IS_LINUX
+		std::vector<epoll_event> readyEvents;
+#endif
+	};
+} // namespace suc
+
+
+
+#endif
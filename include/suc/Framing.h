@@ -0,0 +1,160 @@
+#pragma once
+#ifndef SUCFRAMING_H
+#define SUCFRAMING_H
+
+#include <array>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "SocketUtility.h"
+#include "ByteBuffer.h"
+#include "ClientSocket.h"
+
+namespace suc
+{
+	enum class FrameFormat
+	{
+		FIXED_LENGTH,	// 4-byte length prefix in network byte order
+		VARINT_LENGTH,	// Unsigned LEB128 length prefix, as used by Protocol Buffers
+		DELIMITER,		// Every frame is terminated by a delimiter
+	};
+
+	struct FramingOptions
+	{
+		FrameFormat format{ FrameFormat::FIXED_LENGTH };
+		std::string delimiter{ "\r\n" };				// Only used with FrameFormat::DELIMITER
+		size_t maxFrameSize{ 16 * 1024 * 1024 };	// Larger frames are rejected
+	};
+
+	/* +++ FrameDecoder +++
+	Splits a byte stream into the messages it carries. TCP does not preserve message
+	boundaries: one read may return part of a frame or several frames at once. The decoder
+	buffers incomplete frames until the rest arrives and returns all complete frames of a
+	read, so small messages are batched into a single receive call.
+
+	Frames are slices of the received buffer chain and are not copied. */
+	class FrameDecoder
+	{
+	public:
+		/**
+		 * @param FramingOptions options
+		 *
+		 * @throw value_error if the format is DELIMITER and the delimiter is empty
+		 */
+		explicit FrameDecoder(FramingOptions options = {});
+
+		/**
+		 * Append received data to the stream.
+		 *
+		 * @param ByteBuffer data
+		 */
+		void feed(ByteBuffer data);
+		void feed(std::span<const sbyte> data);
+
+		/**
+		 * Take the next complete frame from the stream.
+		 *
+		 * @return std::optional<ByteBuffer> The payload without prefix or delimiter, or
+		 *         nothing if no complete frame has been received yet.
+		 *
+		 * @throw value_error if a frame exceeds the maximum size or its length prefix is
+		 *        malformed. The stream cannot be decoded any further.
+		 */
+		[[nodiscard]]
+		auto next() -> std::optional<ByteBuffer>;
+
+		/**
+		 * Read all available data from a socket and decode every complete frame.
+		 *
+		 * @param ClientSocket&            socket
+		 * @param std::vector<ByteBuffer>& frames  Complete frames are appended to this
+		 * @param int                      timeout Time in milliseconds to wait for data,
+		 *                                         see ClientSocket::recv(). Data may arrive
+		 *                                         without completing a frame.
+		 *
+		 * @return RecvResult The number of bytes that have been read. If the status is
+		 *         RecvStatus::CLOSED while data is buffered, the last frame is truncated.
+		 *
+		 * @throw suc_error, value_error like next()
+		 */
+		auto recv(ClientSocket& socket, std::vector<ByteBuffer>& frames, int timeout = TIMEOUT_NEVER) -> RecvResult;
+
+		/**
+		 * @return size_t Bytes of incomplete frames.
+		 */
+		[[nodiscard]]
+		auto getBufferedSize() const noexcept -> size_t;
+
+	private:
+		static constexpr size_t MAX_VARINT_SIZE = 10;
+
+		/**
+		 * @return std::optional<std::pair<size_t, size_t>> Size of the prefix and length of
+		 *         the payload if the prefix is complete.
+		 */
+		auto decodePrefix() const -> std::optional<std::pair<size_t, size_t>>;
+		auto nextDelimited() -> std::optional<ByteBuffer>;
+
+		FramingOptions options;
+		ByteBuffer buffer;
+		size_t scanOffset{ 0 }; // The delimiter is not in front of this offset
+	};
+
+	/* +++ FrameEncoder +++
+	Writes messages in the format that FrameDecoder reads. The prefix or delimiter is sent
+	together with the payload in one vectored write. */
+	class FrameEncoder
+	{
+	public:
+		/**
+		 * @param FramingOptions options
+		 *
+		 * @throw value_error if the format is DELIMITER and the delimiter is empty
+		 */
+		explicit FrameEncoder(FramingOptions options = {});
+
+		/**
+		 * Send a single frame.
+		 *
+		 * @param ClientSocket&          socket
+		 * @param std::span<const sbyte> payload Must not contain the delimiter if the format
+		 *                                       is DELIMITER.
+		 *
+		 * @throw suc_error, or value_error if the payload exceeds the maximum frame size
+		 */
+		void send(ClientSocket& socket, std::span<const sbyte> payload) const;
+		void send(ClientSocket& socket, const ByteBuffer& payload) const;
+
+		/**
+		 * Append a frame to a buffer, e.g. to send several frames at once. A span payload
+		 * is copied, which packs small frames densely; a ByteBuffer payload is linked into
+		 * the chain.
+		 *
+		 * @param std::span<const sbyte> payload
+		 * @param ByteBuffer&            out
+		 *
+		 * @throw value_error if the payload exceeds the maximum frame size
+		 */
+		void encode(std::span<const sbyte> payload, ByteBuffer& out) const;
+		void encode(const ByteBuffer& payload, ByteBuffer& out) const;
+
+	private:
+		static constexpr size_t MAX_PREFIX_SIZE = 10;
+		using Prefix = std::array<ubyte, MAX_PREFIX_SIZE>;
+
+		/**
+		 * @return size_t The size of the prefix. Zero for FrameFormat::DELIMITER.
+		 *
+		 * @throw value_error
+		 */
+		auto encodePrefix(size_t length, Prefix& prefix) const -> size_t;
+
+		FramingOptions options;
+	};
+} // namespace suc
+
+
+
+#endif
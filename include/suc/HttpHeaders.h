@@ -0,0 +1,439 @@
+#pragma once
+#ifndef SUCHTTPHEADERS_H
+#define SUCHTTPHEADERS_H
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "SocketUtility.h"
+
+namespace suc
+{
+	/*
+	Header names that are interned when a header is stored, so that looking them up
+	compares integers instead of strings. */
+	enum class HttpHeaderId : ubyte
+	{
+		ACCEPT,
+		ACCEPT_CHARSET,
+		ACCEPT_ENCODING,
+		ACCEPT_LANGUAGE,
+		ACCEPT_RANGES,
+		ACCESS_CONTROL_ALLOW_ORIGIN,
+		AGE,
+		ALLOW,
+		AUTHORIZATION,
+		CACHE_CONTROL,
+		CONNECTION,
+		CONTENT_DISPOSITION,
+		CONTENT_ENCODING,
+		CONTENT_LANGUAGE,
+		CONTENT_LENGTH,
+		CONTENT_LOCATION,
+		CONTENT_RANGE,
+		CONTENT_TYPE,
+		COOKIE,
+		DATE,
+		ETAG,
+		EXPECT,
+		EXPIRES,
+		FORWARDED,
+		FROM,
+		HOST,
+		IF_MATCH,
+		IF_MODIFIED_SINCE,
+		IF_NONE_MATCH,
+		IF_RANGE,
+		IF_UNMODIFIED_SINCE,
+		KEEP_ALIVE,
+		LAST_MODIFIED,
+		LINK,
+		LOCATION,
+		MAX_FORWARDS,
+		ORIGIN,
+		PRAGMA,
+		PROXY_AUTHENTICATE,
+		PROXY_AUTHORIZATION,
+		RANGE,
+		REFERER,
+		RETRY_AFTER,
+		SERVER,
+		SET_COOKIE,
+		TE,
+		TRAILER,
+		TRANSFER_ENCODING,
+		UPGRADE,
+		USER_AGENT,
+		VARY,
+		VIA,
+		WWW_AUTHENTICATE,
+		X_FORWARDED_FOR,
+
+		UNKNOWN, // Any other name
+	};
+
+	namespace internal
+	{
+		// Indexed by HttpHeaderId
+		constexpr std::string_view HEADER_NAMES[]{
+			"Accept", "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges",
+			"Access-Control-Allow-Origin", "Age", "Allow", "Authorization", "Cache-Control",
+			"Connection", "Content-Disposition", "Content-Encoding", "Content-Language",
+			"Content-Length", "Content-Location", "Content-Range", "Content-Type", "Cookie",
+			"Date", "ETag", "Expect", "Expires", "Forwarded", "From", "Host", "If-Match",
+			"If-Modified-Since", "If-None-Match", "If-Range", "If-Unmodified-Since", "Keep-Alive",
+			"Last-Modified", "Link", "Location", "Max-Forwards", "Origin", "Pragma",
+			"Proxy-Authenticate", "Proxy-Authorization", "Range", "Referer", "Retry-After",
+			"Server", "Set-Cookie", "TE", "Trailer", "Transfer-Encoding", "Upgrade", "User-Agent",
+			"Vary", "Via", "WWW-Authenticate", "X-Forwarded-For",
+		};
+		static_assert(std::size(HEADER_NAMES) == static_cast<size_t>(HttpHeaderId::UNKNOWN));
+
+		constexpr size_t HEADER_TABLE_BITS = 9;
+		constexpr size_t HEADER_TABLE_SIZE = 1 << HEADER_TABLE_BITS;
+
+		constexpr auto toLower(char c) noexcept -> char
+		{
+			return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+		}
+
+		/*
+		Only looks at the length and the first, middle and last byte, which already tell the
+		well-known names apart. This is cheaper than hashing every byte of every received
+		name; the one candidate is compared in full anyway. */
+		constexpr auto hashHeaderName(std::string_view name, uint seed) noexcept -> size_t
+		{
+			if (name.empty()) {
+				return 0;
+			}
+
+			const auto byte = [&](size_t i) { return static_cast<uint>(static_cast<ubyte>(toLower(name[i]))); };
+			const uint key = static_cast<uint>(name.size())
+				| byte(0) << 8
+				| byte(name.size() / 2) << 16
+				| byte(name.size() - 1) << 24;
+
+			return (key * seed) >> (32 - HEADER_TABLE_BITS);
+		}
+
+		/*
+		Searches for a multiplier with which the hashes of all well-known names differ. */
+		constexpr auto findPerfectSeed() noexcept -> uint
+		{
+			for (uint seed = 0x9e3779b1U; ; seed += 2)
+			{
+				std::array<bool, HEADER_TABLE_SIZE> used{};
+				bool collision = false;
+				for (std::string_view name : HEADER_NAMES)
+				{
+					const size_t slot = hashHeaderName(name, seed);
+					collision = collision || used[slot];
+					used[slot] = true;
+				}
+				if (!collision) {
+					return seed;
+				}
+			}
+		}
+
+		constexpr uint HEADER_SEED = findPerfectSeed();
+
+		constexpr auto HEADER_TABLE = [] {
+			std::array<HttpHeaderId, HEADER_TABLE_SIZE> table{};
+			table.fill(HttpHeaderId::UNKNOWN);
+			for (size_t i = 0; i < std::size(HEADER_NAMES); i++) {
+				table[hashHeaderName(HEADER_NAMES[i], HEADER_SEED)] = static_cast<HttpHeaderId>(i);
+			}
+			return table;
+		}();
+	} // namespace internal
+
+	constexpr bool equalsIgnoreCase(std::string_view a, std::string_view b) noexcept
+	{
+		return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char lhs, char rhs) {
+			return internal::toLower(lhs) == internal::toLower(rhs);
+		});
+	}
+
+	/**
+	 * Intern a header name. Computes one hash and compares the name with at most one
+	 * well-known name.
+	 *
+	 * @param std::string_view name Compared case-insensitively
+	 *
+	 * @return HttpHeaderId UNKNOWN if the name is not well-known
+	 */
+	constexpr auto getHttpHeaderId(std::string_view name) noexcept -> HttpHeaderId
+	{
+		const HttpHeaderId id = internal::HEADER_TABLE[internal::hashHeaderName(name, internal::HEADER_SEED)];
+		if (id == HttpHeaderId::UNKNOWN || !equalsIgnoreCase(name, internal::HEADER_NAMES[static_cast<size_t>(id)])) {
+			return HttpHeaderId::UNKNOWN;
+		}
+
+		return id;
+	}
+
+	/**
+	 * @return std::string_view The usual spelling of a well-known name, empty for UNKNOWN
+	 */
+	constexpr auto getHttpHeaderName(HttpHeaderId id) noexcept -> std::string_view
+	{
+		return id == HttpHeaderId::UNKNOWN ? std::string_view() : internal::HEADER_NAMES[static_cast<size_t>(id)];
+	}
+
+	/* +++ BasicHttpHeaders +++
+	Header fields in the order in which they have been added. The first INLINE_CAPACITY
+	fields are stored in the object itself; only messages with more headers allocate.
+
+	Names are compared case-insensitively. Well-known names are interned when a field is
+	stored, so looking them up compares their ids. Only fields with other names are
+	compared byte by byte.
+
+	String is std::string for headers that own their text and std::string_view for headers
+	that refer to a received message. */
+	template<typename String, size_t INLINE_CAPACITY = 16>
+	class BasicHttpHeaders
+	{
+	public:
+		struct Field
+		{
+			HttpHeaderId id{ HttpHeaderId::UNKNOWN };
+			String name;
+			String value;
+		};
+
+		BasicHttpHeaders() = default;
+		BasicHttpHeaders(std::initializer_list<std::pair<std::string_view, std::string_view>> fields)
+		{
+			for (const auto& [name, value] : fields) {
+				add(name, value);
+			}
+		}
+
+		BasicHttpHeaders(const BasicHttpHeaders&) = default;
+		BasicHttpHeaders& operator=(const BasicHttpHeaders&) = default;
+
+		// The count must be reset because it refers to the overflow vector if that is in use
+		BasicHttpHeaders(BasicHttpHeaders&& other) noexcept
+			:
+			inlineFields(std::move(other.inlineFields)),
+			overflow(std::move(other.overflow)),
+			count(std::exchange(other.count, 0))
+		{
+		}
+
+		BasicHttpHeaders& operator=(BasicHttpHeaders&& other) noexcept
+		{
+			if (this != &other)
+			{
+				inlineFields = std::move(other.inlineFields);
+				overflow = std::move(other.overflow);
+				count = std::exchange(other.count, 0);
+				other.overflow.clear();
+			}
+			return *this;
+		}
+
+		~BasicHttpHeaders() noexcept = default;
+
+		/**
+		 * Append a field, even if one with the same name exists.
+		 */
+		void add(std::string_view name, std::string_view value)
+		{
+			push({ getHttpHeaderId(name), String(name), String(value) });
+		}
+
+		/**
+		 * Replace the value of the first field with the name, or append a field if there
+		 * is none.
+		 */
+		void set(std::string_view name, std::string_view value)
+		{
+			set(getHttpHeaderId(name), name, value);
+		}
+
+		void set(HttpHeaderId id, std::string_view value)
+		{
+			set(id, getHttpHeaderName(id), value);
+		}
+
+		[[nodiscard]]
+		bool contains(std::string_view name) const noexcept
+		{
+			return find(getHttpHeaderId(name), name) != nullptr;
+		}
+
+		[[nodiscard]]
+		bool contains(HttpHeaderId id) const noexcept
+		{
+			return find(id, getHttpHeaderName(id)) != nullptr;
+		}
+
+		/**
+		 * @return std::optional<std::string_view> The value of the first field with the
+		 *         name, nothing if there is none.
+		 */
+		[[nodiscard]]
+		auto get(std::string_view name) const noexcept -> std::optional<std::string_view>
+		{
+			return get(getHttpHeaderId(name), name);
+		}
+
+		[[nodiscard]]
+		auto get(HttpHeaderId id) const noexcept -> std::optional<std::string_view>
+		{
+			return get(id, getHttpHeaderName(id));
+		}
+
+		/**
+		 * Remove all fields with the name.
+		 *
+		 * @return bool True if a field has been removed
+		 */
+		bool erase(std::string_view name)
+		{
+			return erase(getHttpHeaderId(name), name);
+		}
+
+		bool erase(HttpHeaderId id)
+		{
+			return erase(id, getHttpHeaderName(id));
+		}
+
+		/**
+		 * Keeps allocated memory. The inline fields are overwritten when fields are added
+		 * again.
+		 */
+		void clear() noexcept
+		{
+			overflow.clear();
+			count = 0;
+		}
+
+		[[nodiscard]]
+		auto size() const noexcept -> size_t { return count; }
+		[[nodiscard]]
+		bool empty() const noexcept { return count == 0; }
+
+		[[nodiscard]]
+		auto begin() const noexcept -> const Field* { return getData(); }
+		[[nodiscard]]
+		auto end() const noexcept -> const Field* { return getData() + count; }
+
+		[[nodiscard]]
+		auto operator[](size_t index) const noexcept -> const Field& { return getData()[index]; }
+
+	private:
+		static bool matches(const Field& field, HttpHeaderId id, std::string_view name) noexcept
+		{
+			if (id != HttpHeaderId::UNKNOWN) {
+				return field.id == id;
+			}
+			return field.id == HttpHeaderId::UNKNOWN && equalsIgnoreCase(field.name, name);
+		}
+
+		/*
+		The name is only compared if the id is UNKNOWN. */
+		auto find(HttpHeaderId id, std::string_view name) const noexcept -> const Field*
+		{
+			for (const Field& field : *this)
+			{
+				if (matches(field, id, name)) {
+					return &field;
+				}
+			}
+
+			return nullptr;
+		}
+
+		void set(HttpHeaderId id, std::string_view name, std::string_view value)
+		{
+			if (const Field* field = find(id, name)) {
+				const_cast<Field*>(field)->value = String(value);
+			}
+			else {
+				push({ id, String(name), String(value) });
+			}
+		}
+
+		auto get(HttpHeaderId id, std::string_view name) const noexcept -> std::optional<std::string_view>
+		{
+			const Field* field = find(id, name);
+			return field == nullptr ? std::nullopt : std::optional<std::string_view>(field->value);
+		}
+
+		bool erase(HttpHeaderId id, std::string_view name)
+		{
+			const auto fields = getFields();
+			const auto end = std::remove_if(fields.begin(), fields.end(), [&](const Field& field) {
+				return matches(field, id, name);
+			});
+			const auto removed = static_cast<size_t>(fields.end() - end);
+			for (size_t i = 0; i < removed; i++) {
+				pop();
+			}
+
+			return removed > 0;
+		}
+
+		// All fields are in the overflow vector once it is in use
+		auto getData() const noexcept -> const Field*
+		{
+			return overflow.empty() ? inlineFields.data() : overflow.data();
+		}
+
+		auto getFields() noexcept -> std::span<Field>
+		{
+			return { const_cast<Field*>(getData()), count };
+		}
+
+		void push(Field field)
+		{
+			if (count < INLINE_CAPACITY && overflow.empty())
+			{
+				inlineFields[count++] = std::move(field);
+				return;
+			}
+
+			if (overflow.empty())
+			{
+				overflow.reserve(INLINE_CAPACITY * 2);
+				std::move(inlineFields.begin(), inlineFields.end(), std::back_inserter(overflow));
+				inlineFields.fill({});
+			}
+			overflow.push_back(std::move(field));
+			count++;
+		}
+
+		void pop() noexcept
+		{
+			if (overflow.empty()) {
+				inlineFields[count - 1] = {};
+			}
+			else {
+				overflow.pop_back();
+			}
+			count--;
+		}
+
+		std::array<Field, INLINE_CAPACITY> inlineFields;
+		std::vector<Field> overflow;
+		size_t count{ 0 };
+	};
+
+	using HttpHeaders = BasicHttpHeaders<std::string>;
+	using HttpHeaderViews = BasicHttpHeaders<std::string_view>;
+} // namespace suc
+
+
+
+#endif
@@ -0,0 +1,133 @@
+#pragma once
+#ifndef SUCHTTPPARSER_H
+#define SUCHTTPPARSER_H
+
+#include <string_view>
+#include <vector>
+
+#include "HttpHeaders.h"
+#include "SocketUtility.h"
+
+namespace suc
+{
+	struct HttpParserOptions
+	{
+		size_t maxRequestLineSize{ 8 * 1024 };	// Including leading empty lines
+		size_t maxHeaderSize{ 16 * 1024 };		// All header lines together
+		size_t maxHeaderCount{ 100 };
+	};
+
+	enum class HttpParseStatus
+	{
+		INCOMPLETE,				// More data is needed
+		COMPLETE,				// The head has been parsed, see HttpRequestParser::getHead()
+		INVALID,				// Malformed request; respond with 400 Bad Request
+		REQUEST_LINE_TOO_LONG,	// Respond with 414 Request-URI Too Large
+		HEADERS_TOO_LARGE,		// Respond with 431 Request Header Fields Too Large
+	};
+
+	/*
+	The request line and headers of a HTTP/1.x request. All views point into the parsed data. */
+	struct HttpRequestHead
+	{
+		std::string_view method;
+		std::string_view target;	// The request URI as sent
+		std::string_view path;		// The target up to the query
+		std::string_view query;		// Behind the '?', empty if there is none
+		std::string_view version;
+		HttpHeaderViews headers;	// Values without surrounding whitespace
+		size_t size;				// Bytes of the head including the empty line; the body starts here
+	};
+
+	/* +++ HttpRequestParser +++
+	Parses the head of a HTTP/1.x request while it arrives. parse() may be called with
+	partial input as often as necessary; every call only examines the bytes that have been
+	added since the previous one. The parsed fields are views into the input, nothing is
+	copied.
+
+	The size limits are also enforced on incomplete input, so a client cannot make the
+	server buffer an unbounded head.
+
+	Call reset() before parsing the next request. */
+	class HttpRequestParser
+	{
+	public:
+		explicit HttpRequestParser(HttpParserOptions options = {});
+
+		/**
+		 * Continue parsing.
+		 *
+		 * @param std::string_view data All data that has been received for this request,
+		 *                              starting at the same byte on every call. The data
+		 *                              may have moved in memory since the previous call.
+		 *
+		 * @return HttpParseStatus Once COMPLETE or an error has been returned, every
+		 *         further call returns the same status until reset() is called.
+		 */
+		auto parse(std::string_view data) -> HttpParseStatus;
+
+		/**
+		 * @return const HttpRequestHead& The parsed head. Only valid after parse() has
+		 *         returned COMPLETE; the views point into the data of that call.
+		 */
+		[[nodiscard]]
+		auto getHead() const noexcept -> const HttpRequestHead&;
+
+		/**
+		 * Prepare for the next request. Keeps allocated memory.
+		 */
+		void reset() noexcept;
+
+	private:
+		enum class State
+		{
+			REQUEST_LINE,
+			HEADERS,
+			DONE,
+		};
+
+		/*
+		A field as offsets, which stay valid when the input moves. */
+		struct Range
+		{
+			size_t offset;
+			size_t length;
+
+			[[nodiscard]]
+			auto in(std::string_view data) const noexcept -> std::string_view;
+		};
+
+		struct HeaderRange
+		{
+			Range name;
+			Range value;
+		};
+
+		/**
+		 * @param std::string_view line   Without the line break
+		 * @param size_t           offset Position of the line in the input
+		 */
+		bool parseRequestLine(std::string_view line, size_t offset);
+		bool parseHeaderLine(std::string_view line, size_t offset);
+		auto fail(HttpParseStatus status) noexcept -> HttpParseStatus;
+		void makeHead(std::string_view data);
+
+		HttpParserOptions options;
+
+		State state{ State::REQUEST_LINE };
+		HttpParseStatus status{ HttpParseStatus::INCOMPLETE };
+		size_t lineStart{ 0 };		// First byte of the current line
+		size_t scanned{ 0 };		// There is no line break in front of this offset
+		size_t headersStart{ 0 };
+
+		Range method{};
+		Range target{};
+		Range version{};
+		std::vector<HeaderRange> headers;
+		HttpRequestHead head{};
+	};
+} // namespace suc
+
+
+
+#endif
@@ -0,0 +1,168 @@
+#pragma once
+#ifndef SUCHTTPROUTER_H
+#define SUCHTTPROUTER_H
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SocketUtility.h"
+
+#undef DELETE // So I can use the identifier DELETE in HttpMethod
+
+namespace suc
+{
+	class HttpRequest;
+	class HttpResponse;
+
+	enum class HttpMethod
+	{
+		OPTIONS,
+		GET, HEAD,
+		POST, PUT, DELETE,
+		TRACE, CONNECT,
+		extension
+	};
+
+	/*
+	The values of the parameters and the wildcard of a matched route. The values are views
+	into the request path. */
+	class RouteParameters
+	{
+	public:
+		static constexpr size_t MAX_PARAMETERS = 16;
+
+		/**
+		 * @param std::string_view name The name in the route pattern, without ':' or '*'
+		 *
+		 * @return std::optional<std::string_view> Nothing if the route has no such parameter
+		 */
+		[[nodiscard]]
+		auto get(std::string_view name) const noexcept -> std::optional<std::string_view>;
+
+		[[nodiscard]]
+		auto size() const noexcept -> size_t;
+
+	private:
+		friend class HttpRouter;
+
+		struct Parameter
+		{
+			std::string_view name;
+			std::string_view value;
+		};
+
+		std::array<Parameter, MAX_PARAMETERS> parameters{};
+		size_t count{ 0 };
+	};
+
+	/* +++ HttpRouter +++
+	Maps a request's method and path to a handler.
+
+	Patterns consist of static text, parameters and a wildcard, e.g. "/users/:id/posts":
+
+		:name	Matches one non-empty path segment
+		*name	Matches the rest of the path, which may be empty. Only allowed as the last
+				segment.
+
+	The routes are stored in a radix tree whose edges are the static parts of the patterns.
+	Matching walks the path once and is independent of the number of routes. Where several
+	routes for the request's method match, static text takes precedence over parameters, and
+	parameters over wildcards. Routes for other methods do not hide them. Matching does not
+	allocate.
+
+	Routes must be added before the router is used concurrently; matching is thread-safe. */
+	class HttpRouter
+	{
+	public:
+		using Handler = std::function<HttpResponse(const HttpRequest&, const RouteParameters&)>;
+
+		/*
+		Bitmask with bit (1 << HttpMethod) set for each method. */
+		using MethodSet = uint;
+
+		struct Match
+		{
+			const Handler* handler{ nullptr };	// Nullptr if no route matches the method and path
+			MethodSet allowedMethods{ 0 };		// Methods with a route for the path, e.g. for 405 Method Not Allowed
+		};
+
+		HttpRouter();
+		~HttpRouter() noexcept;
+
+		HttpRouter(const HttpRouter&) = delete;
+		HttpRouter(HttpRouter&&) noexcept;
+		HttpRouter& operator=(const HttpRouter&) = delete;
+		HttpRouter& operator=(HttpRouter&&) noexcept;
+
+		/**
+		 * @param HttpMethod       method
+		 * @param std::string_view pattern Must start with '/'
+		 * @param Handler          handler
+		 *
+		 * @throw value_error if the pattern is malformed, uses a parameter name twice,
+		 *        conflicts with the name of a parameter at the same position, or has
+		 *        already been added for the method
+		 */
+		void add(HttpMethod method, std::string_view pattern, Handler handler);
+
+		/**
+		 * @param HttpMethod       method
+		 * @param std::string_view path       The path of the request, without the query
+		 * @param RouteParameters& parameters Receives the parameters of the matched route
+		 */
+		[[nodiscard]]
+		auto match(HttpMethod method, std::string_view path, RouteParameters& parameters) const noexcept -> Match;
+
+		/**
+		 * @return size_t The number of routes, counting each method separately.
+		 */
+		[[nodiscard]]
+		auto size() const noexcept -> size_t;
+
+	private:
+		static constexpr size_t METHOD_COUNT = static_cast<size_t>(HttpMethod::extension) + 1;
+		static constexpr int NO_HANDLER = -1;
+
+		/*
+		A node matches its prefix, or one path segment if it is a parameter, or the rest of
+		the path if it is a wildcard. */
+		struct Node
+		{
+			std::string prefix;			// Static text; the name for parameters and wildcards
+			std::string indices;		// The first byte of each static child's prefix
+			std::vector<std::unique_ptr<Node>> children;
+			std::unique_ptr<Node> parameter;
+			std::unique_ptr<Node> wildcard;
+
+			std::array<int, METHOD_COUNT> handlers;	// Indices into HttpRouter::handlers
+			MethodSet methods{ 0 };
+		};
+
+		static auto insertStatic(Node& node, std::string_view text) -> Node&;
+		static auto insertNamed(std::unique_ptr<Node>& slot, std::string_view name) -> Node&;
+		static auto makeNode(std::string_view prefix) -> std::unique_ptr<Node>;
+
+		/**
+		 * @param MethodSet methods Only nodes with a handler for one of these methods match
+		 */
+		static auto find(const Node& node, std::string_view path, MethodSet methods, RouteParameters& parameters) noexcept
+			-> const Node*;
+
+		/**
+		 * @return MethodSet The methods of all routes that match the path
+		 */
+		static auto findMethods(const Node& node, std::string_view path) noexcept -> MethodSet;
+
+		std::unique_ptr<Node> root;
+		std::vector<Handler> handlers;
+	};
+} // namespace suc
+
+
+
+#endif
@@ -2,22 +2,30 @@
 #ifndef HHTPSERVER_H
 #define HTTPSERVER_H
 
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <string_view>
 #include <list>
 #include <unordered_map>
 #include <functional>
+#include <future>
+#include <memory>
 #include <optional>
-#include <pointers>
+#include <thread>
 
+#include "Async.h"
+#include "BufferPool.h"
 #include "ByteBuffer.h"
-
-#undef DELETE // So I can use the identifier DELETE in HttpRequest::Method
+#include "EventLoop.h"
+#include "HttpHeaders.h"
+#include "HttpParser.h"
+#include "HttpRouter.h"
 
 namespace suc
 {
 	class ClientSocket;
-	class AsyncClient;
-	class AsyncServer;
+	class HttpServer;
 
 	constexpr auto CRLF = "\r\n";
 	constexpr auto HTTP_VERSION_1_1 = "HTTP/1.1";
@@ -58,6 +66,7 @@ namespace suc
 		REQUESTED_RANGE_NOT_SATISFIABLE = 416,
 		EXPECTATION_FAILED				= 417,
 		IM_A_TEAPOT						= 418,
+		REQUEST_HEADER_FIELDS_TOO_LARGE	= 431,
 		INTERNAL_SERVER_ERROR			= 500,
 		NOT_IMPLEMENTED					= 501,
 		BAD_GATEWAY						= 502,
@@ -102,6 +111,7 @@ namespace suc
 		{ HttpStatusCode::REQUESTED_RANGE_NOT_SATISFIABLE,	"Requested range not satisfiable" },
 		{ HttpStatusCode::EXPECTATION_FAILED,				"Expectation Failed" },
 		{ HttpStatusCode::IM_A_TEAPOT,						"I'm a teapot" },
+		{ HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE,	"Request Header Fields Too Large" },
 		{ HttpStatusCode::INTERNAL_SERVER_ERROR,			"Internal Server Error" },
 		{ HttpStatusCode::NOT_IMPLEMENTED,					"Not Implemented" },
 		{ HttpStatusCode::BAD_GATEWAY,						"Bad Gateway" },
@@ -118,7 +128,7 @@ namespace suc
 		using str_str_map = std::unordered_map<std::string, std::string>;
 		using str_str_pair = std::pair<std::string, std::string>;
 		using Options = str_str_map;
-		using Headers = str_str_map;
+		using Headers = HttpHeaders;
 		using option_type = str_str_pair;
 		using header_type = str_str_pair;
 
@@ -129,20 +139,62 @@ namespace suc
 		void setContent(std::string body);
 		void setContent(ByteBuffer body);
 
+		/**
+		 * Use a file as the body. sendTo() transmits it with sendfile(2), so the file is
+		 * never read into memory.
+		 *
+		 * @param const std::string& path The file is opened immediately and closed when the
+		 *                                last response that refers to it is destroyed.
+		 *
+		 * @throw system_error if the file cannot be opened
+		 */
+		void setContentFile(const std::string& path);
+
+		/**
+		 * Use a range of an open file as the body.
+		 *
+		 * @param int    fd     Must stay open until the response has been sent
+		 * @param ulong  offset
+		 * @param size_t length
+		 */
+		void setContentFile(int fd, ulong offset, size_t length);
+
+		/**
+		 * @return std::string The complete response. Does not contain the body if it is
+		 *         a file.
+		 */
 		[[nodiscard]]
 		auto getRaw() const noexcept -> std::string;
-		void sendTo(gsl::not_null<ClientSocket*> client);
+		void sendTo(ClientSocket& client);
 
 	private:
+		friend HttpServer;
+
 		static constexpr auto RESPONSE_HTTP_VERSION = HTTP_VERSION_1_1;
+		/**
+		 * @return PooledString Status line and headers, including the empty line that
+		 *         separates them from the body.
+		 */
 		[[nodiscard]]
-		auto makeStatusLine() const noexcept -> std::string;
+		auto makeHead() const -> PooledString;
 		[[nodiscard]]
-		static auto makeHeaderString(const header_type& header) noexcept -> std::string;
+		auto makeStatusLine() const noexcept -> std::string;
+		static void appendHeaderString(PooledString& result, const Headers::Field& header);
+
+		/*
+		A body that is sent from a file. */
+		struct FileContent
+		{
+			std::shared_ptr<const int> ownedFd; // Closes the file, empty if not owned
+			int fd;
+			ulong offset;
+			size_t length;
+		};
 
 		HttpStatusCode status;
 		Headers headers;
 		ByteBuffer content;
+		std::optional<FileContent> fileContent; // Replaces content if set
 	};
 
 	/*
@@ -153,89 +205,210 @@ namespace suc
 		using str_str_map = std::unordered_map<std::string, std::string>;
 		using str_str_pair = std::pair<std::string, std::string>;
 		using Options = str_str_map;
-		using Headers = str_str_map;
+		using Headers = HttpHeaderViews;
 		using option_type = str_str_pair;
 		using header_type = str_str_pair;
 
 	private:
-		struct RequestLine;
-		HttpRequest(gsl::not_null<ClientSocket*> sender, RequestLine requestLine, Headers headers);
+		HttpRequest(ClientSocket& sender, ByteBuffer message, HttpRequestHead head);
 
 	public:
-		enum class Method {
-			OPTIONS,
-			GET, HEAD,
-			POST, PUT, DELETE,
-			TRACE, CONNECT,
-			extension
-		};
-
-		static auto parseRequest(const ByteBuffer& msg, gsl::not_null<ClientSocket*> client)
+		using Method = HttpMethod;
+
+		/**
+		 * @param const ByteBuffer& msg A complete request head. The request keeps a
+		 *                              reference to the memory instead of copying it.
+		 *
+		 * @throw InvalidHttpRequestException
+		 */
+		static auto parseRequest(const ByteBuffer& msg, ClientSocket& client)
 			-> HttpRequest;
 
 		[[nodiscard]]
 		auto getMethod() const noexcept -> Method;
 
 		[[nodiscard]]
-		auto getPath() const noexcept -> std::string;
+		auto getPath() const noexcept -> std::string_view;
 
 		[[nodiscard]]
 		bool hasOption(const std::string& key) const noexcept;
 		[[nodiscard]]
 		auto getOption(const std::string& key) const noexcept -> std::optional<std::string>;
 
+		/**
+		 * Header names are compared case-insensitively.
+		 */
 		[[nodiscard]]
-		bool hasHeader(const std::string& key) const noexcept;
+		bool hasHeader(std::string_view key) const noexcept;
 		[[nodiscard]]
-		auto getHeader(const std::string& key) const noexcept -> std::optional<std::string>;
+		auto getHeader(std::string_view key) const noexcept -> std::optional<std::string_view>;
+
+		/**
+		 * @return ByteBuffer The message body, which shares the memory of the request.
+		 *         Empty if the request has none.
+		 */
+		[[nodiscard]]
+		auto getBody() const -> ByteBuffer;
 
 		void respond(HttpResponse response);
 
 	private:
+		friend HttpServer;
+
+
 		/*
 		Thrown from HttpRequest::parseRequest when the provided ByteBuffer
 		contains no valid HTTP-Request. */
 		class InvalidHttpRequestException : public suc_error
 		{
 		public:
-			explicit InvalidHttpRequestException(const std::string& msg = "")
-				: suc_error(msg) {}
-		};
+			explicit InvalidHttpRequestException(const std::string& msg = "",
+												 HttpStatusCode status = HttpStatusCode::BAD_REQUEST)
+				: suc_error(msg), status(status) {}
 
-		struct RequestLine {
-			Method method;
-			std::string path;
-			Options options;
-			std::string version;
+			const HttpStatusCode status; // The response that the client should receive
 		};
-		static auto parseRequestLine(const std::string& requestLine) -> RequestLine;
-		static auto parseMethod(const std::string& method) -> Method;
-		static auto parseHeader(const std::string& headerLine) -> header_type;
+
+		static auto parseMethod(std::string_view method) -> Method;
+		static auto parseOptions(std::string_view query) -> Options;
 
 		ClientSocket* sender;
-		const RequestLine requestLine;
-		const Headers headers;
+		ByteBuffer message; // Owns the memory that head refers to
+		HttpRequestHead head;
+		Method method;
+		Options options;
+	};
+
+	struct HttpServerOptions
+	{
+		uint maxRequestsPerConnection{ 1000 };	// The connection is closed after this many, 0 for no limit
+		int keepAliveTimeout{ 5000 };			// Milliseconds an idle connection is kept open
+		int requestTimeout{ 5000 };				// Milliseconds from the first byte of a request until it is complete
+		size_t maxBodySize{ 1024 * 1024 };
+		uint workerCount{ 64 };					// Requests that are received and handled at the same time
+		HttpParserOptions parser{};
 	};
 
 	/*
-	A HTTP server. */
+	A HTTP/1.1 server that dispatches requests with a HttpRouter. Requests without a route
+	are answered with 404 Not Found, or 405 Method Not Allowed if the path has routes for
+	other methods.
+
+	Connections are persistent: a client can send any number of requests over one
+	connection, and may send the next requests before it has received the responses to the
+	previous ones (pipelining). All requests that arrive in one read are answered in order
+	with a single write.
+
+	Idle connections wait in an EventLoop on a thread of their own, where their keep-alive
+	timeouts are timers of the loop's TimerWheel. A connection occupies a worker thread only
+	from the arrival of a request until the responses to all requests that have arrived
+	are sent, so the worker count limits the number of requests that are served
+	concurrently, not the number of open connections. The request timeout frees workers
+	from clients that send a request slowly; it is not extended by partial reads. */
 	class HttpServer
 	{
 	public:
-		explicit HttpServer(int port);
-		HttpServer(const HttpServer&) = default;
-		HttpServer(HttpServer&&) noexcept = default;
+		/**
+		 * Starts the server.
+		 *
+		 * @param int               port
+		 * @param HttpRouter        router  The routes cannot be changed while the server runs
+		 * @param HttpServerOptions options
+		 *
+		 * @throw suc_error if the port cannot be bound
+		 */
+		HttpServer(int port, HttpRouter router, HttpServerOptions options = {});
 		~HttpServer() noexcept;
 
-		HttpServer& operator=(const HttpServer&) = default;
-		HttpServer& operator=(HttpServer&&) noexcept = default;
+		HttpServer(const HttpServer&) = delete;
+		HttpServer(HttpServer&&) noexcept = delete;
+		HttpServer& operator=(const HttpServer&) = delete;
+		HttpServer& operator=(HttpServer&&) noexcept = delete;
 
 	private:
-		AsyncServer* server;
+		using clock = std::chrono::steady_clock;
+
+		// Maximum time between two checks whether the server is stopping
+		static constexpr int STOP_CHECK_INTERVAL = 100;
+		// Delay before a connection is offered to the workers again if all were busy
+		static constexpr int WORKER_RETRY_DELAY = 10;
+
+		/*
+		A connection that waits for its next request in the idle loop. The timer is its
+		keep-alive timeout, or the retry delay while it waits for a worker. */
+		struct IdleConnection : TimerWheel::Timer
+		{
+			IdleConnection(HttpServer& server, ClientSocket client, uint requestCount);
+
+			HttpServer& server;
+			ClientSocket client;
+			uint requestCount;	// Requests served on the connection so far
+			std::optional<clock::time_point> workerDeadline; // Set while all workers are busy
+		};
 
-		void handleConnection(AsyncClient* newClient);
-		void handleClientMessage(const ByteBuffer& msg, gsl::not_null<ClientSocket*> client);
-		void handleClientTerminate(AsyncClient* client);
+		/**
+		 * Serve requests until the connection is idle, then park it.
+		 *
+		 * @param ClientSocket client       A connection on which data has arrived
+		 * @param uint         requestCount Requests served on the connection so far
+		 */
+		void handleConnection(ClientSocket client, uint requestCount);
+		auto handleRequest(const HttpRequest& request) -> HttpResponse;
+
+		/**
+		 * Stop accepting, wait for the workers and close all connections.
+		 */
+		void shutdown() noexcept;
+
+		/**
+		 * Hand a connection to the idle loop, which resumes it on a worker once data
+		 * arrives. Thread-safe.
+		 */
+		void park(ClientSocket client, uint requestCount);
+
+		// Called on the idle loop's thread
+		void runIdleLoop(std::promise<void>& started);
+		void watch(std::shared_ptr<IdleConnection> connection);
+		void resume(SOCKET socket, EventLoop::event_flags events);
+		void dispatch(std::shared_ptr<IdleConnection> connection);
+		static void onIdleTimeout(TimerWheel::Timer& timer);
+
+		/**
+		 * Take the next complete request from the front of the buffer.
+		 *
+		 * @param size_t& requestSize Size of the request once its head is complete, zero
+		 *                            before. Later calls wait for the body without
+		 *                            parsing or coalescing the buffer again.
+		 *
+		 * @return std::optional<HttpRequest> Nothing if the request is incomplete
+		 *
+		 * @throw HttpRequest::InvalidHttpRequestException
+		 */
+		auto readRequest(ByteBuffer& buffer, HttpRequestParser& parser, size_t& requestSize,
+		                 ClientSocket& client) -> std::optional<HttpRequest>;
+
+		/**
+		 * Wait for more data until the deadline.
+		 *
+		 * @return RecvStatus TIMEOUT if the deadline has passed or the server is stopping
+		 */
+		auto receive(ClientSocket& client, ByteBuffer& buffer, clock::time_point deadline) -> RecvStatus;
+
+		/**
+		 * Send responses with as few calls as possible. Only bodies from files are
+		 * sent separately.
+		 */
+		static void sendResponses(ClientSocket& client, const std::vector<HttpResponse>& responses);
+
+		const HttpServerOptions options;
+		const HttpRouter router;
+		std::atomic<bool> shouldStop{ false };
+
+		std::unique_ptr<EventLoop> idleLoop; // Created and run by idleThread
+		std::unordered_map<SOCKET, std::shared_ptr<IdleConnection>> idleConnections; // Only used by idleThread
+		std::thread idleThread;
+		std::unique_ptr<WorkerPool> workers;
+		AsyncServer server;
 	};
 } // namespace suc
 
@@ -2,12 +2,18 @@
 #ifndef SUCINTERNALS_H
 #define SUCINTERNALS_H
 
+#include <chrono>
+
 #include "SocketUtility.h"
+#include "Resolver.h"
 
-constexpr auto ADDRESS_TRANSLATE_MAX_TRY_AGAIN = 10;
+constexpr auto ADDRESS_TRANSLATE_MAX_TRY_AGAIN = 3;
+constexpr auto ADDRESS_TRANSLATE_RETRY_DELAY_MS = 10; // Doubled after each attempt
+constexpr size_t SUC_MAX_IOV = 64; // Buffers per vectored send, well below IOV_MAX
 
 /**
- * @brief Resolve an IP address to an addrinfo struct
+ * @brief Resolve an IP address or host name. Bypasses the resolver cache,
+ *        use suc::Resolver unless that is intended.
  *
  * @param ip_address: The IP address in readable string format.
  * @param port: The port.
@@ -16,13 +22,35 @@ constexpr auto ADDRESS_TRANSLATE_MAX_TRY_AGAIN = 10;
  * @param protocol: IPPROTO_TCP
  * @param flags: NULL
  *
- * @return Returns a addrinfo structure if the translation has been
- *         successful, nullptr otherwise.
+ * @return Returns the resolved addresses. Never empty.
+ *
+ * @throw suc::network_error if the address cannot be resolved.
  */
-extern addrinfo* translateAddress(
+extern auto translateAddress(
 	const std::string& ip_address, int port,
 	int family, int type, int protocol, int flags
-);
+) -> suc::AddressList;
+
+/**
+ * @brief Turn a timeout in milliseconds into a point in time
+ *
+ * @param timeout: The timeout, may be TIMEOUT_NEVER.
+ *
+ * @return Returns time_point::max() for TIMEOUT_NEVER.
+ */
+extern auto makeDeadline(int timeout) -> std::chrono::steady_clock::time_point;
+
+/**
+ * @brief Find the position at which an incremental search for a byte sequence continues
+ *        after the sequence has not been found in the data received so far
+ *
+ * @param searched: The number of bytes that have been searched.
+ * @param sequenceSize: The length of the sequence.
+ *
+ * @return Returns the position of the first byte that may still start the sequence once
+ *         more data has arrived. The bytes before it are not searched again.
+ */
+extern auto resumeSequenceSearch(size_t searched, size_t sequenceSize) -> size_t;
 
 
 #ifdef OS_IS_WINDOWS
@@ -73,10 +101,18 @@ extern SOCKET suc_socket  (int domain, int type, int protocol);
 extern int    suc_bind    (SOCKET s, sockaddr* addr, int addrlen);
 extern int    suc_listen  (SOCKET s, int backlog);
 extern SOCKET suc_accept  (SOCKET s, sockaddr* addr, int* addrlen);
-extern int    suc_connect (SOCKET s, sockaddr* addr, int addrlen);
+extern SOCKET suc_accept4 (SOCKET s, sockaddr* addr, int* addrlen, bool nonblocking); // Also close-on-exec
+extern int    suc_connect (SOCKET s, const sockaddr* addr, int addrlen);
 extern int    suc_recv    (SOCKET s, void* buf, size_t len, int flags);
 extern int    suc_send    (SOCKET s, const void* buf, size_t len, int flags);
+extern int    suc_sendv   (SOCKET s, const iovec* buffers, size_t count, int flags); // count <= SUC_MAX_IOV
+extern long   suc_sendfile(SOCKET s, int fd, ulong* offset, size_t count); // Advances offset
 extern int    suc_select  (int nfds, fd_set* readfds, fd_set* writefds, fd_set* exceptfds, timeval* timeout);
+extern int    suc_poll    (pollfd* fds, size_t nfds, int timeout);
+extern int    suc_setsockopt(SOCKET s, int level, int optname, const void* optval, int optlen);
+extern int    suc_getsockopt(SOCKET s, int level, int optname, void* optval, int* optlen);
+extern int    suc_set_nonblocking(SOCKET s, bool nonblocking);
+extern int    suc_shutdown(SOCKET s);
 extern int    suc_close   (SOCKET s);
 
 static inline auto getLastError()
@@ -95,6 +131,13 @@ static inline auto getLastError()
 [[noreturn]]
 extern void handleLastError();
 
+/**
+ * @brief Generate a suitable exception for an error code, e.g. one
+ *        reported through SO_ERROR or an io_uring completion
+ */
+[[noreturn]]
+extern void handleError(int error);
+
 #ifdef OS_IS_WINDOWS
 	#define EACCES WSAEACCES
 	#define EADDRINUSE WSAEADDRINUSE
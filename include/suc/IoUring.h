@@ -0,0 +1,160 @@
+#pragma once
+#ifndef SUCIOURING_H
+#define SUCIOURING_H
+
+#include <optional>
+
+#include "SocketUtility.h"
+
+#ifdef OS_IS_LINUX
+	#include <linux/io_uring.h>
+#endif
+
+namespace suc
+{
+	/**
+	 * The mechanism that the asynchronous parts of the library (AsyncServer) use to wait
+	 * for I/O.
+	 */
+	enum class IoEngine
+	{
+		EPOLL,		// Readiness notification, one syscall per operation
+		IO_URING	// Completion queue with batched submission and multishot operations
+	};
+
+	/**
+	 * Select the I/O engine. Falls back to IoEngine::EPOLL if the running kernel does not
+	 * support the io_uring features that the library requires.
+	 *
+	 * Only affects servers that are started after the call.
+	 *
+	 * @param IoEngine engine The preferred engine
+	 *
+	 * @return IoEngine The engine that is actually used.
+	 */
+	auto setIoEngine(IoEngine engine) noexcept -> IoEngine;
+
+	/**
+	 * @return IoEngine The currently selected I/O engine. Defaults to IoEngine::EPOLL.
+	 */
+	[[nodiscard]]
+	auto getIoEngine() noexcept -> IoEngine;
+
+	/* +++ IoUring +++
+	A thin wrapper around an io_uring submission and completion queue.
+
+	Operations are queued with the prepare*() methods and handed to the kernel in a single
+	io_uring_enter call by submit(). A multishot accept keeps producing completions from one
+	submission until it fails or is cancelled.
+
+	Not thread-safe. */
+	class IoUring
+	{
+	public:
+		struct Completion
+		{
+			ulong userData;
+			int result;		// Like the return value of the synchronous call, or -errno
+			uint flags;
+
+			/**
+			 * @return bool True if the operation stays armed and will generate more completions.
+			 */
+			[[nodiscard]]
+			bool hasMore() const noexcept;
+		};
+
+		/**
+		 * Tests whether the kernel supports io_uring with multishot accept (Linux 5.19 and
+		 * later). The result is cached.
+		 */
+		[[nodiscard]]
+		static bool isSupported() noexcept;
+
+		/**
+		 * @param uint entries Size of the submission queue. Rounded up to a power of two.
+		 *
+		 * @throw suc_error
+		 */
+		explicit IoUring(uint entries = DEFAULT_ENTRIES);
+		~IoUring() noexcept;
+
+		IoUring(const IoUring&) = delete;
+		IoUring(IoUring&&) noexcept = delete;
+		IoUring& operator=(const IoUring&) = delete;
+		IoUring& operator=(IoUring&&) noexcept = delete;
+
+		/**
+		 * Queue an accept on a listening socket. The result of each completion is the
+		 * descriptor of a new connection.
+		 *
+		 * @param bool multishot If true, one submission accepts connections until cancelled.
+		 */
+		void prepareAccept(SOCKET listener, ulong userData, bool multishot = true);
+
+		/**
+		 * Queue a send. The buffer must stay valid until the completion has been processed.
+		 */
+		void prepareSend(SOCKET socket, const void* buf, size_t size, ulong userData);
+
+		/**
+		 * Queue a read from an arbitrary descriptor, e.g. an eventfd.
+		 */
+		void prepareRead(int fd, void* buf, size_t size, ulong userData);
+
+		/**
+		 * Queue the cancellation of all operations that have been submitted with userData.
+		 */
+		void prepareCancel(ulong userData);
+
+		/**
+		 * Submit all queued operations with a single system call.
+		 *
+		 * @param uint waitFor Block until at least this many completions are available.
+		 *
+		 * @return uint The number of submitted operations.
+		 *
+		 * @throw suc_error
+		 */
+		auto submit(uint waitFor = 0) -> uint;
+
+		/**
+		 * Take the next completion from the completion queue without blocking.
+		 */
+		auto popCompletion() noexcept -> std::optional<Completion>;
+
+	private:
+		static constexpr uint DEFAULT_ENTRIES = 256;
+
+#ifdef OS_IS_LINUX
+		auto nextSqe() -> io_uring_sqe*;
+		void release() noexcept;
+
+		int ringFd{ -1 };
+
+		void* sqRingPtr{ nullptr };
+		size_t sqRingBytes{ 0 };
+		void* cqRingPtr{ nullptr };
+		size_t cqRingBytes{ 0 };
+		io_uring_sqe* sqes{ nullptr };
+		size_t sqesBytes{ 0 };
+
+		uint* sqHead{ nullptr };
+		uint* sqTail{ nullptr };
+		uint* sqArray{ nullptr };
+		uint sqMask{ 0 };
+		uint sqEntries{ 0 };
+		uint sqLocalTail{ 0 };	// Includes prepared but not yet submitted entries
+		uint sqPending{ 0 };	// Prepared entries not yet passed to io_uring_enter
+
+		uint* cqHead{ nullptr };
+		uint* cqTail{ nullptr };
+		io_uring_cqe* cqes{ nullptr };
+		uint cqMask{ 0 };
+#endif
+	};
+} // namespace suc
+
+
+
+#endif
@@ -0,0 +1,130 @@
+#pragma once
+#ifndef SUCOUTBOUNDQUEUE_H
+#define SUCOUTBOUNDQUEUE_H
+
+#include <deque>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "SocketUtility.h"
+#include "EventLoop.h"
+
+namespace suc
+{
+	class ClientSocket;
+
+	/* +++ OutboundQueue +++
+	Buffers outgoing data of a socket that the peer does not read fast enough.
+
+	write() never blocks. It sends as much as the socket accepts right away and queues the
+	rest, which is written whenever the socket becomes writable again. The event loop waits
+	for writability through a Waiter, so the socket may be registered with the same loop for
+	reading at the same time.
+
+	The watermarks implement backpressure: once more than the high watermark is queued,
+	write() returns false and the producer should pause until onWritable is called, which
+	happens when the queue has shrunk below the low watermark.
+
+	Must be used on the thread that runs the event loop. */
+	class OutboundQueue : EventLoop::Waiter
+	{
+	public:
+		/**
+		 * @param ClientSocket& socket        Must outlive the queue
+		 * @param EventLoop&    loop          Must outlive the queue
+		 * @param size_t        lowWatermark  onWritable is called when the queue shrinks
+		 *                                    below this size after exceeding highWatermark
+		 * @param size_t        highWatermark write() returns false above this size
+		 */
+		OutboundQueue(ClientSocket& socket,
+					  EventLoop& loop,
+					  size_t lowWatermark = DEFAULT_LOW_WATERMARK,
+					  size_t highWatermark = DEFAULT_HIGH_WATERMARK);
+
+		/**
+		 * Discards the data that has not been sent yet.
+		 */
+		~OutboundQueue() noexcept;
+
+		OutboundQueue(const OutboundQueue&) = delete;
+		OutboundQueue(OutboundQueue&&) noexcept = delete;
+		OutboundQueue& operator=(const OutboundQueue&) = delete;
+		OutboundQueue& operator=(OutboundQueue&&) noexcept = delete;
+
+		/**
+		 * Send data or queue it if the socket's send buffer is full.
+		 *
+		 * @param std::span<const sbyte> data
+		 *
+		 * @return bool False if the queue has exceeded the high watermark. The data has
+		 *              been queued nonetheless.
+		 *
+		 * @throw suc_error if sending fails
+		 */
+		bool write(std::span<const sbyte> data);
+		bool write(const std::string& str);
+
+		/**
+		 * @param std::function<void()> f Called when the queue has shrunk below the low
+		 *                                watermark after write() has returned false.
+		 */
+		void onWritable(std::function<void()> f);
+
+		/**
+		 * @param std::function<void()> f Called when all queued data has been sent, after
+		 *                                onWritable if both apply. The queue may be
+		 *                                destroyed from within this callback, but not
+		 *                                from within onWritable.
+		 */
+		void onDrain(std::function<void()> f);
+
+		/**
+		 * @param std::function<void(const suc_error&)> f Called when sending queued data
+		 *        fails, e.g. because the peer has reset the connection. The queue is
+		 *        cleared. Without an error callback, the error is propagated from
+		 *        EventLoop::poll().
+		 */
+		void onError(std::function<void(const suc_error&)> f);
+
+		/**
+		 * @return size_t The number of bytes that have not been sent yet.
+		 */
+		[[nodiscard]]
+		auto size() const noexcept -> size_t;
+
+		[[nodiscard]]
+		bool empty() const noexcept;
+
+	private:
+		static constexpr size_t DEFAULT_LOW_WATERMARK = 64 * 1024;
+		static constexpr size_t DEFAULT_HIGH_WATERMARK = 1024 * 1024;
+		static constexpr size_t CHUNK_SIZE = 16 * 1024; // Small writes are coalesced up to this size
+
+		/**
+		 * Send queued data until the queue is empty or the socket would block.
+		 *
+		 * @throw suc_error
+		 */
+		void flush();
+		void handleWritable();
+
+		EventLoop& loop;
+		const size_t lowWatermark;
+		const size_t highWatermark;
+
+		std::deque<std::vector<sbyte>> chunks;
+		size_t offset{ 0 }; // Bytes of the first chunk that have already been sent
+		size_t queuedBytes{ 0 };
+		bool isArmed{ false };
+		bool isPaused{ false }; // write() has returned false
+
+		std::function<void()> onWritableFunc;
+		std::function<void()> onDrainFunc;
+		std::function<void(const suc_error&)> onErrorFunc;
+	};
+} // namespace suc
+
+
+
+#endif
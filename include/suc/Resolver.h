@@ -0,0 +1,187 @@
+#pragma once
+#ifndef SUCRESOLVER_H
+#define SUCRESOLVER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "SocketUtility.h"
+
+namespace suc
+{
+	/* +++ ResolvedAddress +++
+	One result of a name resolution. Unlike addrinfo, this owns its storage. */
+	struct ResolvedAddress
+	{
+		int family;
+		int type;
+		int protocol;
+		sockaddr_storage address;
+		int length;
+
+		[[nodiscard]]
+		auto getSockaddr() const noexcept -> const sockaddr*
+		{
+			return reinterpret_cast<const sockaddr*>(&address);
+		}
+	};
+
+	using AddressList = std::vector<ResolvedAddress>;
+
+	/* +++ Resolver +++
+	A thread-safe cache in front of getaddrinfo.
+
+	Successful resolutions are cached for a fixed time to live, failed ones for a (shorter)
+	negative time to live. getaddrinfo does not report the TTLs of the underlying DNS
+	records, so both are configured here. Concurrent requests for a name that is being
+	resolved wait for the pending resolution instead of starting their own.
+
+	resolveAsync() performs cache misses on a dedicated resolver thread. */
+	class Resolver
+	{
+	public:
+		using AddressListPtr = std::shared_ptr<const AddressList>;
+
+		struct Stats
+		{
+			ulong hits;
+			ulong negativeHits;	// Hits on a cached failure
+			ulong misses;
+			size_t entries;
+		};
+
+		/**
+		 * @return Resolver& The resolver that ClientSocket::connect() uses.
+		 */
+		[[nodiscard]]
+		static auto getDefault() -> Resolver&;
+
+		/**
+		 * @param std::chrono::seconds ttl         Time to live of successful resolutions
+		 * @param std::chrono::seconds negativeTtl Time to live of failed resolutions
+		 * @param size_t               maxEntries  Expired entries are evicted when the cache
+		 *                                         grows beyond this size.
+		 */
+		explicit Resolver(std::chrono::seconds ttl = DEFAULT_TTL,
+						  std::chrono::seconds negativeTtl = DEFAULT_NEGATIVE_TTL,
+						  size_t maxEntries = DEFAULT_MAX_ENTRIES);
+
+		/**
+		 * Stops the resolver thread. Pending asynchronous resolutions fail.
+		 */
+		~Resolver() noexcept;
+
+		Resolver(const Resolver&) = delete;
+		Resolver(Resolver&&) noexcept = delete;
+		Resolver& operator=(const Resolver&) = delete;
+		Resolver& operator=(Resolver&&) noexcept = delete;
+
+		/**
+		 * Resolve a host name, blocking on a cache miss.
+		 *
+		 * @param std::string host   Host name or numeric address
+		 * @param int         port
+		 * @param int         family IPV4, IPV6 or IPVX
+		 *
+		 * @return AddressListPtr A non-empty list of stream socket addresses.
+		 *
+		 * @throw network_error if the name cannot be resolved
+		 */
+		auto resolve(const std::string& host, int port, int family = IPVX) -> AddressListPtr;
+
+		/**
+		 * Resolve a host name without blocking. Cache misses are resolved on the resolver
+		 * thread.
+		 *
+		 * @return std::shared_future<AddressListPtr> Rethrows network_error on get() if the
+		 *         name cannot be resolved.
+		 */
+		auto resolveAsync(const std::string& host, int port, int family = IPVX)
+			-> std::shared_future<AddressListPtr>;
+
+		/**
+		 * Remove all cached entries. Pending resolutions are not affected.
+		 */
+		void clear();
+
+		[[nodiscard]]
+		auto getStats() const -> Stats;
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		static constexpr std::chrono::seconds DEFAULT_TTL{ 30 };
+		static constexpr std::chrono::seconds DEFAULT_NEGATIVE_TTL{ 5 };
+		static constexpr size_t DEFAULT_MAX_ENTRIES = 1024;
+
+		struct Key
+		{
+			std::string host;
+			int port;
+			int family;
+
+			bool operator==(const Key&) const = default;
+		};
+
+		struct KeyHash
+		{
+			auto operator()(const Key& key) const noexcept -> size_t;
+		};
+
+		struct Entry
+		{
+			std::shared_future<AddressListPtr> result;
+			clock::time_point expires{ clock::time_point::max() }; // Set when resolved
+			bool failed{ false };
+			ulong id{ 0 };
+		};
+
+		/*
+		A pending resolution. */
+		struct Job
+		{
+			Key key;
+			ulong entryId;
+			std::promise<AddressListPtr> promise;
+		};
+
+		/**
+		 * Looks up the key. On a miss, inserts a pending entry and returns the job that
+		 * resolves it through newJob.
+		 */
+		auto lookup(const Key& key, std::optional<Job>& newJob) -> std::shared_future<AddressListPtr>;
+		void complete(Job& job);
+		void evict(clock::time_point now);
+		void runResolverThread();
+
+		const std::chrono::seconds ttl;
+		const std::chrono::seconds negativeTtl;
+		const size_t maxEntries;
+
+		mutable std::mutex cacheMutex;
+		std::unordered_map<Key, Entry, KeyHash> cache;
+		ulong hits{ 0 };
+		ulong negativeHits{ 0 };
+		ulong misses{ 0 };
+		ulong nextEntryId{ 0 };
+
+		std::mutex jobMutex;
+		std::condition_variable jobAvailable;
+		std::queue<Job> jobs;
+		bool shouldStop{ false };
+		std::thread resolverThread;
+	};
+} // namespace suc
+
+
+
+#endif
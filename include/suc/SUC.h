@@ -4,7 +4,24 @@
 #include "SocketUtility.h"
 #include "ServerSocket.h"
 #include "ClientSocket.h"
+#include "AdaptiveBufferSizer.h"
+#include "BufferedReader.h"
+#include "BufferPool.h"
+#include "ByteBuffer.h"
+#include "ConnectionPool.h"
+#include "Resolver.h"
 #include "Async.h"
+#include "EventLoop.h"
+#include "Framing.h"
+#include "HttpParser.h"
+#include "HttpRouter.h"
+#include "OutboundQueue.h"
+#include "Scan.h"
+#include "Coroutine.h"
+#include "IoUring.h"
+#include "TimerWheel.h"
+#include "WorkerPool.h"
+#include "ZeroCopy.h"
 
 
 
@@ -0,0 +1,70 @@
+#pragma once
+#ifndef SUCSCAN_H
+#define SUCSCAN_H
+
+#include <string_view>
+
+namespace suc
+{
+	/*
+	Instruction sets for the scanning functions below. The best one that the CPU supports
+	is selected when the library is loaded. */
+	enum class ScanKernel
+	{
+		SCALAR,
+		SSE42,	// 16 bytes per step
+		AVX2,	// 32 bytes per step
+	};
+
+	/**
+	 * Find the first occurrence of a byte. Uses the C library's memchr, which is
+	 * vectorized on all common platforms.
+	 *
+	 * @param std::string_view data
+	 * @param char             c
+	 * @param size_t           from Position to start the search at
+	 *
+	 * @return size_t Position of the byte, or std::string_view::npos
+	 */
+	[[nodiscard]]
+	auto findByte(std::string_view data, char c, size_t from = 0) noexcept -> size_t;
+
+	/**
+	 * Find the first byte that is one of a set of bytes, e.g. the delimiters of a URI
+	 * query "&=". The vectorized kernels support sets of up to 16 bytes, larger sets are
+	 * scanned one byte at a time.
+	 *
+	 * @return size_t Position of the byte, or std::string_view::npos
+	 */
+	[[nodiscard]]
+	auto findAnyOf(std::string_view data, std::string_view set, size_t from = 0) noexcept -> size_t;
+
+	/**
+	 * Find the first occurrence of a byte sequence, e.g. "\r\n".
+	 *
+	 * @return size_t Position of the first byte of the sequence, or
+	 *         std::string_view::npos. An empty sequence is found at from.
+	 */
+	[[nodiscard]]
+	auto findSequence(std::string_view data, std::string_view sequence, size_t from = 0) noexcept -> size_t;
+
+	/**
+	 * @return ScanKernel The kernel that the scanning functions currently use
+	 */
+	[[nodiscard]]
+	auto getScanKernel() noexcept -> ScanKernel;
+
+	[[nodiscard]]
+	bool isScanKernelSupported(ScanKernel kernel) noexcept;
+
+	/**
+	 * Select a different kernel, e.g. to compare them in a benchmark. Affects all threads.
+	 *
+	 * @throw value_error if the CPU does not support the kernel
+	 */
+	void setScanKernel(ScanKernel kernel);
+} // namespace suc
+
+
+
+#endif
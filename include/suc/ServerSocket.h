@@ -2,18 +2,55 @@
 #define SERVERSOCKET_H
 
 #include <memory>
+#include <vector>
 
 #include "SocketUtility.h"
+#include "ClientSocket.h"
+#include "Coroutine.h"
 
 // TODO:
 // Create a custom address structure that encapsulates the #ifdef hacks
 
 namespace suc
 {
-	class ClientSocket;
+	/* +++ ServerSocketOptions +++
+	Socket options that are applied before a ServerSocket is bound. */
+	struct ServerSocketOptions
+	{
+		/**
+		 * Sets SO_REUSEPORT. Several sockets with this option may be bound to the same port;
+		 * the kernel load-balances incoming connections between them.
+		 */
+		bool reusePort{ false };
+
+		/**
+		 * Length of the queue of established connections that have not been accepted
+		 * yet. Linux silently caps this at net.core.somaxconn.
+		 */
+		int backlog{ SOMAXCONN };
+	};
+
+	/* +++ AcceptedConnection +++
+	A connection returned by ServerSocket::acceptAll() together with the address of the
+	peer. */
+	struct AcceptedConnection
+	{
+		ClientSocket socket;
+		sockaddr_storage peerAddress;
+		int peerAddressLength;
+
+		[[nodiscard]]
+		auto getPeerAddress() const noexcept -> const sockaddr*
+		{
+			return reinterpret_cast<const sockaddr*>(&peerAddress);
+		}
+	};
 
 	/* +++ ServerSocket +++
-	A TCP server socket. */
+	A TCP server socket.
+
+	The listening descriptor is non-blocking so that acceptAll() can drain the backlog;
+	accept() waits for connections nonetheless. */
 	class ServerSocket
 	{
 	public:
@@ -24,10 +61,11 @@ namespace suc
 		 * 
 		 * @param int port   The port that the server will listen to
 		 * @param int family The IP family that the server will be compatible with
+		 * @param ServerSocketOptions options
 		 * 
 		 * @throw suc_error
 		 */
-		explicit ServerSocket(int port, int family = IPV4);
+		explicit ServerSocket(int port, int family = IPV4, ServerSocketOptions options = {});
 
 		ServerSocket(const ServerSocket&) = delete;
 		ServerSocket(ServerSocket&& other) noexcept;
@@ -47,10 +85,11 @@ namespace suc
 		 * @param int family The IP family that the server will be compatible with. Must
 		 * 					 be either suc::IPV4 or suc::IPV6.
 		 * 					 TODO: suc::IPV6 is currently not available.
+		 * @param ServerSocketOptions options
 		 * 
 		 * @throw suc_error
 		 */
-		void bind(int port, int family = IPV4);
+		void bind(int port, int family = IPV4, ServerSocketOptions options = {});
 
 		/**
 		 * Wait for an incoming connection.
@@ -65,6 +104,45 @@ namespace suc
 		[[nodiscard]]
 		auto accept() const -> ClientSocket;
 
+		/**
+		 * Accept all pending connections at once.
+		 * 
+		 * Waits until at least one connection is pending, then accepts connections until
+		 * the backlog is empty or maxConnections have been accepted. Each connection costs a
+		 * single accept4() call which also sets the socket flags.
+		 * 
+		 * @param int    timeout        Time in milliseconds to wait for the first connection.
+		 *                              TIMEOUT_NEVER blocks until a client connects.
+		 * @param size_t maxConnections Upper limit for the size of the batch
+		 * @param bool   nonBlocking    Put the new sockets into non-blocking mode, as
+		 *                              required by EventLoop and the coroutine API. The
+		 *                              blocking methods of ClientSocket expect blocking
+		 *                              sockets. All sockets are close-on-exec.
+		 * 
+		 * @return std::vector<AcceptedConnection> The new connections. Empty if the timeout
+		 *         expired.
+		 * 
+		 * @throw suc_error if waiting fails or the first accept fails. Errors after the first
+		 *        connection end the batch early; they occur again on the next call.
+		 */
+		[[nodiscard]]
+		auto acceptAll(int timeout = TIMEOUT_NEVER,
+					   size_t maxConnections = DEFAULT_MAX_ACCEPT_BATCH,
+					   bool nonBlocking = true) const -> std::vector<AcceptedConnection>;
+
+		/**
+		 * Wait for an incoming connection inside a coroutine.
+		 * 
+		 * The calling coroutine is suspended until a client connects and resumed by the
+		 * calling thread's current EventLoop (see EventLoop::getCurrent()).
+		 * 
+		 * @return AcceptAwaitable Yields the new, non-blocking ClientSocket when awaited.
+		 * 
+		 * @throw suc_error when awaited
+		 */
+		[[nodiscard]]
+		auto asyncAccept() const -> AcceptAwaitable;
+
 		/**
 		 * Close the socket.
 		 * 
@@ -83,7 +161,24 @@ namespace suc
 		[[nodiscard]]
 		bool isClosed() const noexcept;
 
+		/**
+		 * Access the underlying socket descriptor, e.g. to register it with an EventLoop.
+		 *
+		 * @return SOCKET The native descriptor. INVALID_SOCKET if the socket has never been opened.
+		 */
+		[[nodiscard]]
+		auto getNativeHandle() const noexcept -> SOCKET;
+
 	private:
+		static constexpr size_t DEFAULT_MAX_ACCEPT_BATCH = 64;
+
+		/**
+		 * Wait until a connection is pending or the socket is shut down.
+		 *
+		 * @return bool False if the timeout has expired.
+		 */
+		bool waitForConnection(int timeout) const;
+
 		bool _isClosed{ true };
 		SOCKET socket{ INVALID_SOCKET };
 
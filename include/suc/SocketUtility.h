@@ -39,15 +39,25 @@
 	#include <sys/types.h>
 	#include <sys/socket.h>
 	#include <sys/select.h>
+	#include <poll.h>
 	#include <netinet/in.h>
 	#include <arpa/inet.h> // Might fix some segfault
 	#include <unistd.h> // write() and read()
+	#include <fcntl.h>
+	#include <sys/uio.h> // iovec
 #endif
 
 // Datatype defines
 #ifdef OS_IS_WINDOWS
 	//#define SOCKET SOCKET
 	//#define INVALID_SOCKET INVALID_SOCKET
+
+	// The POSIX scatter-gather buffer. Translated to WSABUF internally.
+	struct iovec
+	{
+		void* iov_base;
+		size_t iov_len;
+	};
 #endif
 
 #ifdef OS_IS_LINUX
@@ -62,9 +72,10 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <sstream>
 #include <optional>
 
+#include "Scan.h"
+
 
 namespace suc
 {
@@ -150,49 +161,43 @@ namespace suc
 	// ---------------------------- //
 
 
-	/* Split a string */
-	static inline auto splitString(const std::string& to_str, const char delimiter)
+	/* Split a string at a delimiting character. An empty last token is omitted. */
+	static inline auto splitString(const std::string& str, const char delimiter)
         -> std::vector<std::string>
 	{
 		std::vector<std::string> result;
-		std::stringstream _str;
-		_str << to_str;
-		std::string token;
-		while (std::getline(_str, token, delimiter)) {
-			result.push_back(token);
+
+		size_t tokenStart = 0;
+		for (size_t pos; (pos = findByte(str, delimiter, tokenStart)) != std::string::npos; tokenStart = pos + 1) {
+			result.emplace_back(str, tokenStart, pos - tokenStart);
+		}
+		if (tokenStart < str.size()) {
+			result.emplace_back(str, tokenStart);
 		}
 
 		return result;
 	}
 
-	/* Split a string at a delimiting character sequence. */
+	/* Split a string at a delimiting character sequence. An empty last token is omitted. */
 	static inline auto splitString(const std::string& str, const std::string& delimiter)
         -> std::vector<std::string>
 	{
+		if (delimiter.empty()) {
+			return str.empty() ? std::vector<std::string>{} : std::vector<std::string>{ str };
+		}
+
 		std::vector<std::string> result;
 
-		auto i = str.begin();
-		auto tokenStart = str.begin();
-		for (; i != str.end(); i++)
+		size_t tokenStart = 0;
+		for (size_t pos; (pos = findSequence(str, delimiter, tokenStart)) != std::string::npos;
+			 tokenStart = pos + delimiter.size())
 		{
-			for (auto delim = delimiter.begin(), temp = i;
-				delim != delimiter.end() && temp != str.end();
-				delim++, temp++)
-			{
-				if (*temp != *delim)
-					break;
-				if (delim == delimiter.end() - 1)
-				{
-					result.emplace_back(std::string(tokenStart, i));
-					tokenStart = temp + 1;
-					i = temp; // Not (temp + 1) here because of the i++ in for-loop
-				}
-			}
+			result.emplace_back(str, tokenStart, pos - tokenStart);
 		}
 		// Append the remainder of the input string
-		auto remainingString = std::string(tokenStart, str.end());
-		if (!remainingString.empty())
-			result.push_back(remainingString);
+		if (tokenStart < str.size()) {
+			result.emplace_back(str, tokenStart);
+		}
 
 		return result;
 	}
@@ -0,0 +1,158 @@
+#pragma once
+#ifndef SUCTIMERWHEEL_H
+#define SUCTIMERWHEEL_H
+
+#include <array>
+#include <chrono>
+
+#include "SocketUtility.h"
+
+namespace suc
+{
+	/* +++ TimerWheel +++
+	A hierarchical timing wheel for large numbers of timeouts, such as the idle timeouts and
+	read/write deadlines of every connection of a server.
+
+	Scheduling and cancelling a timer are O(1) and do not allocate; timers are embedded in
+	the objects that own them, like EventLoop::Waiter. Timers fire from advance(), at the
+	earliest at their expiry time and at the latest one resolution later than that.
+
+	Every EventLoop has a wheel that it advances after each poll() (see
+	EventLoop::getTimers()). Not thread-safe. */
+	class TimerWheel
+	{
+		struct Link
+		{
+			Link* prev{ this };
+			Link* next{ this };
+		};
+
+	public:
+		using clock = std::chrono::steady_clock;
+
+		/* +++ Timer +++
+		A timer that can be scheduled with a TimerWheel. It is usually embedded in the object
+		that it belongs to, which the callback retrieves with a static_cast. A timer cancels
+		itself when it is destroyed. */
+		class Timer : Link
+		{
+		public:
+			using Callback = void(*)(Timer&);
+
+			Timer() noexcept = default;
+			explicit Timer(Callback onExpire) noexcept : onExpire(onExpire) {}
+			~Timer() noexcept { cancel(); }
+
+			Timer(const Timer&) = delete;
+			Timer(Timer&&) noexcept = delete;
+			Timer& operator=(const Timer&) = delete;
+			Timer& operator=(Timer&&) noexcept = delete;
+
+			/**
+			 * Does nothing if the timer is not scheduled.
+			 */
+			void cancel() noexcept;
+
+			/**
+			 * @return bool True if the timer is scheduled and has not fired yet.
+			 */
+			[[nodiscard]]
+			bool isScheduled() const noexcept { return wheel != nullptr; }
+
+			/**
+			 * Called by TimerWheel::advance() when the timer expires. The timer is no longer
+			 * scheduled at that point, so the callback may schedule it again.
+			 */
+			Callback onExpire{ nullptr };
+
+		private:
+			friend TimerWheel;
+
+			TimerWheel* wheel{ nullptr };
+			int slot{ -1 }; // level * SLOTS_PER_LEVEL + index; -1 while queued for expiry
+			ulong expiry{ 0 };
+		};
+
+		/**
+		 * @param std::chrono::milliseconds resolution Length of one tick
+		 */
+		explicit TimerWheel(std::chrono::milliseconds resolution = DEFAULT_RESOLUTION);
+
+		/**
+		 * Cancels all timers.
+		 */
+		~TimerWheel() noexcept;
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel(TimerWheel&&) noexcept = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+		TimerWheel& operator=(TimerWheel&&) noexcept = delete;
+
+		/**
+		 * Schedule a timer. Reschedules it if it is already scheduled, which is how idle
+		 * timeouts are usually refreshed.
+		 *
+		 * @param Timer&                    timer Must have a callback
+		 * @param std::chrono::milliseconds delay Time until the timer fires
+		 *
+		 * @throw value_error if the timer has no callback
+		 */
+		void schedule(Timer& timer, std::chrono::milliseconds delay);
+
+		/**
+		 * Fire all timers that have expired. Exceptions thrown by callbacks are propagated;
+		 * the remaining expired timers fire on the next call.
+		 *
+		 * @param clock::time_point now The current time
+		 *
+		 * @return size_t The number of timers that have fired.
+		 */
+		auto advance(clock::time_point now = clock::now()) -> size_t;
+
+		/**
+		 * Get a poll() timeout that wakes the caller up in time for the next expiry. This is
+		 * exact for timers that expire within the next 64 ticks and a lower bound otherwise.
+		 *
+		 * @return int Time in milliseconds, or TIMEOUT_NEVER if no timer is scheduled.
+		 */
+		[[nodiscard]]
+		int getTimeout(clock::time_point now = clock::now()) const noexcept;
+
+		/**
+		 * @return size_t The number of scheduled timers.
+		 */
+		[[nodiscard]]
+		auto size() const noexcept -> size_t;
+
+	private:
+		static constexpr std::chrono::milliseconds DEFAULT_RESOLUTION{ 1 };
+		static constexpr uint SLOT_BITS = 6;
+		static constexpr ulong SLOTS_PER_LEVEL = 1UL << SLOT_BITS;
+		static constexpr uint LEVELS = 4; // 2^24 ticks, about 4.6 hours at 1 ms resolution
+		static constexpr ulong MAX_DELTA = (1UL << (SLOT_BITS * LEVELS)) - 1;
+
+		void insert(Timer& timer);
+		void unlink(Timer& timer) noexcept;
+		void cascade(uint level);
+
+		/**
+		 * @return ulong The next tick at which a slot has to be processed, or 0 if the
+		 *               wheel is empty.
+		 */
+		auto findNextTick() const noexcept -> ulong;
+
+		auto toTick(clock::time_point time) const noexcept -> ulong;
+
+		const std::chrono::milliseconds resolution;
+		const clock::time_point start;
+
+		ulong currentTick{ 0 };
+		size_t timerCount{ 0 };
+		std::array<std::array<Link, SLOTS_PER_LEVEL>, LEVELS> slots;
+		std::array<ulong, LEVELS> occupied{}; // One bit per non-empty slot
+	};
+} // namespace suc
+
+
+
+#endif
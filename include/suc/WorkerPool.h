@@ -0,0 +1,124 @@
+#pragma once
+#ifndef SUCWORKERPOOL_H
+#define SUCWORKERPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "SocketUtility.h"
+
+namespace suc
+{
+	/* +++ WorkerPool +++
+	A fixed set of worker threads that execute submitted tasks.
+
+	Every worker owns a bounded task queue. Submitted tasks are distributed round-robin
+	among the queues; a worker whose queue runs empty steals tasks from the back of the
+	other queues, so one slow task does not hold up the tasks queued behind it. */
+	class WorkerPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		struct Stats
+		{
+			size_t queueDepth;		// Tasks currently waiting in all queues
+			size_t queueCapacity;	// Summed capacity of all queues
+			ulong completedTasks;
+			ulong rejectedTasks;	// Tasks refused by trySubmit() because all queues were full
+
+			std::chrono::nanoseconds averageWaitTime; // Time from submission to execution
+			std::chrono::nanoseconds averageRunTime;
+			std::chrono::nanoseconds maxRunTime;
+		};
+
+		/**
+		 * Starts the worker threads.
+		 *
+		 * @param uint   threadCount   Number of workers. 0 is treated as 1.
+		 * @param size_t queueCapacity Maximum number of waiting tasks per worker
+		 */
+		explicit WorkerPool(uint threadCount = std::thread::hardware_concurrency(),
+							size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+
+		/**
+		 * Executes all tasks that are still queued, then joins the workers.
+		 */
+		~WorkerPool() noexcept;
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool(WorkerPool&&) noexcept = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+		WorkerPool& operator=(WorkerPool&&) noexcept = delete;
+
+		/**
+		 * Queue a task without blocking.
+		 *
+		 * @return bool False if all queues are full. The task is not executed in this case.
+		 */
+		bool trySubmit(Task task);
+
+		/**
+		 * Queue a task. Blocks while all queues are full.
+		 */
+		void submit(Task task);
+
+		[[nodiscard]]
+		auto getThreadCount() const noexcept -> uint;
+
+		[[nodiscard]]
+		auto getStats() const noexcept -> Stats;
+
+	private:
+		static constexpr size_t DEFAULT_QUEUE_CAPACITY = 1024;
+
+		using clock = std::chrono::steady_clock;
+
+		struct Entry
+		{
+			Task task;
+			clock::time_point submitted;
+		};
+
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Entry> entries;
+		};
+
+		bool tryPush(Task& task);
+		auto pop(uint worker) -> std::optional<Entry>;
+		void execute(Entry& entry) noexcept;
+		void work(uint worker);
+
+		const size_t queueCapacity;
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<std::thread> threads;
+
+		std::mutex sleepMutex;
+		std::condition_variable taskAvailable;
+		std::condition_variable spaceAvailable;
+		std::atomic<size_t> pendingTasks{ 0 };
+		std::atomic<uint> waitingSubmitters{ 0 };
+		std::atomic<uint> nextQueue{ 0 };
+		bool shouldStop{ false }; // Guarded by sleepMutex
+
+		std::atomic<ulong> completedTasks{ 0 };
+		std::atomic<ulong> rejectedTasks{ 0 };
+		std::atomic<ulong> totalWaitNanos{ 0 };
+		std::atomic<ulong> totalRunNanos{ 0 };
+		std::atomic<ulong> maxRunNanos{ 0 };
+	};
+} // namespace suc
+
+
+
+#endif
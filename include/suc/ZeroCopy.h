@@ -0,0 +1,152 @@
+#pragma once
+#ifndef SUCZEROCOPY_H
+#define SUCZEROCOPY_H
+
+#include <deque>
+#include <functional>
+#include <span>
+
+#include "SocketUtility.h"
+
+namespace suc
+{
+	class ClientSocket;
+
+	/* +++ ZeroCopySender +++
+	Sends large buffers with MSG_ZEROCOPY. The kernel transmits directly from the caller's
+	memory instead of copying it into the socket buffer, so each buffer has to stay
+	untouched until the kernel reports that it is done with it. The sender collects these
+	reports from the socket's error queue and calls the release callback of each buffer.
+
+	Buffers below the threshold are sent normally: pinning pages and handling the
+	notification costs more than copying small amounts of data. Where MSG_ZEROCOPY is
+	unavailable (Windows, kernels before 4.14), every send copies.
+
+	Note that the kernel copies anyway on loopback and some devices; see
+	Stats::copiedSends. */
+	class ZeroCopySender
+	{
+	public:
+		using Release = std::function<void()>;
+
+		/*
+		Counts send calls. A buffer takes more than one if the socket accepts only part of it. */
+		struct Stats
+		{
+			ulong zeroCopySends;	// Sent with MSG_ZEROCOPY
+			ulong copiedSends;		// Sent with MSG_ZEROCOPY, but the kernel made a copy
+			ulong regularSends;		// Below the threshold or zero-copy unavailable
+		};
+
+		/**
+		 * Enables SO_ZEROCOPY on the socket.
+		 *
+		 * @param ClientSocket& socket    A connected socket. Must outlive the sender.
+		 * @param size_t        threshold Buffers smaller than this are copied
+		 */
+		explicit ZeroCopySender(ClientSocket& socket, size_t threshold = DEFAULT_THRESHOLD);
+
+		/**
+		 * Waits for all outstanding buffers to be released.
+		 */
+		~ZeroCopySender() noexcept;
+
+		ZeroCopySender(const ZeroCopySender&) = delete;
+		ZeroCopySender(ZeroCopySender&&) noexcept = delete;
+		ZeroCopySender& operator=(const ZeroCopySender&) = delete;
+		ZeroCopySender& operator=(ZeroCopySender&&) noexcept = delete;
+
+		/**
+		 * Send a buffer. Blocks until all data has been handed to the kernel, like
+		 * ClientSocket::send().
+		 *
+		 * @param std::span<const sbyte> data    Must not be modified or freed until release
+		 *                                       has been called.
+		 * @param Release                release Called once the kernel no longer needs the
+		 *                                       buffer, from send() or from
+		 *                                       processCompletions(). May be empty.
+		 *
+		 * @throw suc_error
+		 */
+		void send(std::span<const sbyte> data, Release release);
+
+		/**
+		 * Read the completion notifications that have arrived and release the buffers
+		 * that the kernel is done with.
+		 *
+		 * @param int timeout Time in milliseconds to wait for a notification if buffers are
+		 *                    outstanding.
+		 *
+		 * @return size_t The number of released buffers.
+		 *
+		 * @throw suc_error
+		 */
+		auto processCompletions(int timeout = TIMEOUT_INSTANT) -> size_t;
+
+		/**
+		 * Block until all outstanding buffers have been released.
+		 *
+		 * @throw suc_error
+		 */
+		void flush();
+
+		/**
+		 * @return bool True if SO_ZEROCOPY is enabled on the socket.
+		 */
+		[[nodiscard]]
+		bool isEnabled() const noexcept;
+
+		/**
+		 * @return size_t The number of buffers that the kernel may still read from.
+		 */
+		[[nodiscard]]
+		auto getPendingCount() const noexcept -> size_t;
+
+		[[nodiscard]]
+		auto getStats() const noexcept -> Stats;
+
+	private:
+		// The kernel documentation recommends zero-copy only for writes above ~10 KB
+		static constexpr size_t DEFAULT_THRESHOLD = 16 * 1024;
+
+		/*
+		A buffer whose zero-copy sends have not all completed. Every successful send with
+		MSG_ZEROCOPY is identified by a 32-bit counter that wraps around. */
+		struct Pending
+		{
+			uint firstId;
+			uint lastId;
+			uint remaining; // Sends not yet completed
+			Release release;
+		};
+
+		/**
+		 * Send with MSG_ZEROCOPY and count the sends in the buffer.
+		 *
+		 * @return std::span<const sbyte> The data that the kernel would not pin
+		 */
+		auto sendZeroCopy(std::span<const sbyte> data, Pending& buffer) -> std::span<const sbyte>;
+		void sendCopying(std::span<const sbyte> data);
+
+		/**
+		 * Wait until a send would not fail with EAGAIN. Completion notifications that
+		 * arrive in the meantime are processed.
+		 */
+		void waitUntilWritable();
+
+		void complete(uint firstId, uint lastId, bool copied);
+		void releaseCompleted();
+
+		SOCKET socket;
+		const size_t threshold;
+		bool enabled{ false };
+
+		uint nextId{ 0 };
+		std::deque<Pending> pending;
+		Stats stats{};
+	};
+} // namespace suc
+
+
+
+#endif
@@ -0,0 +1,95 @@
+#include "AdaptiveBufferSizer.h"
+
+#include <algorithm>
+#include <array>
+
+
+
+namespace
+{
+	constexpr size_t SMALL_STEP = 16;
+	constexpr size_t SMALL_LIMIT = 512;
+	constexpr size_t LARGE_CLASSES = 22; // 512 B to 1 GiB
+
+	constexpr auto makeSizeTable()
+	{
+		std::array<size_t, SMALL_LIMIT / SMALL_STEP - 1 + LARGE_CLASSES> table{};
+		size_t i = 0;
+		for (size_t size = SMALL_STEP; size < SMALL_LIMIT; size += SMALL_STEP) {
+			table[i++] = size;
+		}
+		for (size_t size = SMALL_LIMIT; i < table.size(); size *= 2) {
+			table[i++] = size;
+		}
+
+		return table;
+	}
+
+	constexpr auto SIZE_TABLE = makeSizeTable();
+} // anonymous namespace
+
+
+
+suc::AdaptiveBufferSizer::AdaptiveBufferSizer(size_t minimum, size_t initial, size_t maximum) noexcept
+	:
+	minIndex(findSizeClass(minimum)),
+	maxIndex(std::max(findSizeClass(maximum), minIndex)),
+	index(std::clamp(findSizeClass(initial), minIndex, maxIndex))
+{
+}
+
+
+auto suc::AdaptiveBufferSizer::nextSize() const noexcept -> size_t
+{
+	return SIZE_TABLE[index];
+}
+
+
+void suc::AdaptiveBufferSizer::record(size_t bytes) noexcept
+{
+	reads++;
+	bytesRead += bytes;
+
+	if (bytes <= SIZE_TABLE[std::max(index, minIndex + INDEX_DECREMENT) - INDEX_DECREMENT])
+	{
+		// Shrink only if the small read was not a one-off
+		if (decreaseNow && index > minIndex)
+		{
+			index = std::max(index - INDEX_DECREMENT, minIndex);
+			decreases++;
+			decreaseNow = false;
+		}
+		else {
+			decreaseNow = true;
+		}
+	}
+	else if (bytes >= SIZE_TABLE[index])
+	{
+		if (index < maxIndex)
+		{
+			index = std::min(index + INDEX_INCREMENT, maxIndex);
+			increases++;
+		}
+		decreaseNow = false;
+	}
+	else {
+		decreaseNow = false;
+	}
+}
+
+
+auto suc::AdaptiveBufferSizer::getStats() const noexcept -> Stats
+{
+	return { nextSize(), reads, bytesRead, increases, decreases };
+}
+
+
+auto suc::AdaptiveBufferSizer::findSizeClass(size_t size) noexcept -> size_t
+{
+	auto it = std::lower_bound(SIZE_TABLE.begin(), SIZE_TABLE.end(), size);
+	if (it == SIZE_TABLE.end()) {
+		return SIZE_TABLE.size() - 1;
+	}
+
+	return static_cast<size_t>(it - SIZE_TABLE.begin());
+}
@@ -1,5 +1,24 @@
 #include "Async.h"
 
+#include <algorithm>
+
+#include "IoUring.h"
+#include "Internals.h"
+
+
+
+namespace
+{
+	/*
+	Errors of a single accept after which the listener is still usable. The limits on
+	descriptors and memory recover once other connections are closed. */
+	bool isTransientAcceptError(int error)
+	{
+		return error == EAGAIN || error == EWOULDBLOCK || error == EINTR || error == ECONNABORTED
+			|| error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM;
+	}
+} // anonymous namespace
+
 
 
 // ------------------------ //
@@ -20,48 +39,208 @@ suc::AsyncServer::AsyncServer(int port, int family, callback<ClientSocket> onCon
 suc::AsyncServer::~AsyncServer() noexcept
 {
 	stop();
-	while (isRunning); // Wait for the thread to terminate
+
+	// Only left if the server is destroyed by one of its own reactors
+	for (auto& thread : reactors) {
+		thread.detach();
+	}
+	workers.reset(); // Finish pending handlers
 }
 
 
 void suc::AsyncServer::start()
 {
-	if (isRunning) return;
+	if (isRunning() && !shouldClose) {
+		return;
+	}
+	joinReactors(); // Reactors that have stopped on their own or after an error
+
+	ServerSocketOptions options;
+	options.reusePort = reactorCount > 1;
+	options.backlog = backlog;
+
+	workers.reset();
+	if (workerCount > 0) {
+		workers = std::make_unique<WorkerPool>(workerCount, workerQueueCapacity);
+	}
+
+	sockets.clear();
+	sockets.resize(reactorCount);
+	for (auto& socket : sockets) {
+		socket.bind(port, family, options);
+	}
+
+	shouldClose = false;
+	runningReactors = reactorCount;
+	for (auto& socket : sockets)
+	{
+		reactors.emplace_back([&, engine = getIoEngine()]() {
+			if (engine == IoEngine::IO_URING) {
+				runIoUringAcceptLoop(socket);
+			}
+			else {
+				runAcceptLoop(socket);
+			}
+
+			if (runningReactors.fetch_sub(1) == 1) {
+				onTerminateFunc();
+			}
+		});
+	}
+}
+
+
+void suc::AsyncServer::stop()
+{
+	shouldClose = true;
+	closeSockets();
+	joinReactors();
+}
+
+
+void suc::AsyncServer::setReactorCount(uint count)
+{
+	reactorCount = std::max(count, 1U);
+}
+
 
-	socket.close();
-	socket.bind(port, family);
+void suc::AsyncServer::setBacklog(int backlog)
+{
+	this->backlog = backlog;
+}
+
+
+void suc::AsyncServer::setWorkerCount(uint threadCount, size_t queueCapacity)
+{
+	workerCount = threadCount;
+	workerQueueCapacity = queueCapacity;
+}
+
+
+auto suc::AsyncServer::getWorkerStats() const -> std::optional<WorkerPool::Stats>
+{
+	if (workers == nullptr) return {};
+
+	return workers->getStats();
+}
 
-	std::thread([&]() {
-		isRunning = true;
-		shouldClose = false;
+
+bool suc::AsyncServer::isRunning() const noexcept
+{
+	return runningReactors > 0;
+}
+
+
+void suc::AsyncServer::runAcceptLoop(ServerSocket& socket)
+{
+	while (!socket.isClosed())
+	{
+		try {
+			// Drains the backlog after each wakeup, which matters during connection bursts
+			for (auto& conn : socket.acceptAll(TIMEOUT_NEVER, ACCEPT_BATCH_SIZE, false)) {
+				dispatchConnection(std::move(conn.socket));
+			}
+		}
+		catch (const suc_error& err) {
+			handleReactorError(err);
+		}
+	}
+}
+
+
+void suc::AsyncServer::runIoUringAcceptLoop(ServerSocket& socket)
+{
+	constexpr ulong ACCEPT_OPERATION = 1;
+
+	try {
+		// One multishot accept yields a completion per connection. All connections
+		// that arrive between two wakeups are reaped with a single io_uring_enter.
+		IoUring ring;
+		ring.prepareAccept(socket.getNativeHandle(), ACCEPT_OPERATION);
 		while (!socket.isClosed())
 		{
-			try {
-				auto newClient = socket.accept();
-				onConnectionFunc(std::move(newClient));
-			}
-			catch (const suc_error& err) {
-				// It is normal for accept() to throw an error when the socket has been
-				// closed. Only call onError when the socket hasn't been closed manually.
-				if (!shouldClose)
-				{
-					stop();
-					onErrorFunc(err);
+			ring.submit(1);
+			while (auto completion = ring.popCompletion())
+			{
+				if (completion->result >= 0) {
+					dispatchConnection(ClientSocket(completion->result));
+				}
+				else if (socket.isClosed() || !isTransientAcceptError(-completion->result)) {
+					handleError(-completion->result);
+				}
+				else if (-completion->result != ECONNABORTED) {
+					// A failed completion ends the multishot accept; re-arming it right
+					// away would fail again while the limit is still exhausted
+					std::this_thread::sleep_for(std::chrono::milliseconds(ACCEPT_RETRY_DELAY));
+				}
+
+				if (!completion->hasMore()) {
+					ring.prepareAccept(socket.getNativeHandle(), ACCEPT_OPERATION);
 				}
 			}
 		}
-		onTerminateFunc();
-		isRunning = false;
-	}).detach();
+	}
+	catch (const suc_error& err) {
+		handleReactorError(err);
+	}
 }
 
 
-void suc::AsyncServer::stop()
+void suc::AsyncServer::handleReactorError(const suc_error& err)
 {
-	shouldClose = true;
-	socket.close();
+	// It is normal for accept() to throw an error when the socket has been
+	// closed. Only call onError when the socket hasn't been closed manually.
+	// An error in one reactor shuts down the whole server.
+	if (!shouldClose.exchange(true))
+	{
+		closeSockets();
+		onErrorFunc(err);
+	}
+}
+
+
+void suc::AsyncServer::dispatchConnection(ClientSocket client)
+{
+	if (workers == nullptr)
+	{
+		onConnectionFunc(std::move(client));
+		return;
+	}
+
+	// std::function requires a copyable target
+	auto shared = std::make_shared<ClientSocket>(std::move(client));
+	workers->submit([this, shared]() {
+		try {
+			onConnectionFunc(std::move(*shared));
+		}
+		catch (const suc_error& err) {
+			// A failing handler affects only its own connection
+			onErrorFunc(err);
+		}
+	});
 }
 
+
+void suc::AsyncServer::closeSockets()
+{
+	for (auto& socket : sockets) {
+		socket.close();
+	}
+}
+
+
+void suc::AsyncServer::joinReactors()
+{
+	// A reactor cannot wait for itself; its thread is joined by a later call
+	const auto self = std::this_thread::get_id();
+	std::erase_if(reactors, [self](std::thread& thread) {
+		if (thread.get_id() == self) return false;
+		thread.join();
+		return true;
+	});
+}
+
+
 void suc::AsyncServer::onConnection(std::function<void(ClientSocket)> f)
 {
 	onConnectionFunc = std::move(f);
@@ -0,0 +1,196 @@
+#include "BufferPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#ifdef OS_IS_LINUX
+	#include <sys/mman.h>
+#endif
+
+
+
+namespace
+{
+	/*
+	Free blocks that are not owned by any thread's pool. */
+	struct Depot
+	{
+		std::mutex mutex;
+		std::array<std::vector<void*>, suc::BufferPool::SIZE_CLASSES.size()> blocks;
+		std::array<size_t, suc::BufferPool::SIZE_CLASSES.size()> carvedBlocks{};
+	};
+
+	auto getDepot() -> Depot&
+	{
+		static Depot depot;
+		return depot;
+	}
+
+	std::atomic<size_t> residentBytes{ 0 };
+	std::atomic<bool> useHugePages{ false };
+
+	/**
+	 * @return void* A zeroed, page-aligned slab of SLAB_SIZE bytes or nullptr
+	 */
+	auto mapSlab() -> void*
+	{
+		constexpr size_t size = suc::BufferPool::SLAB_SIZE;
+
+#ifdef OS_IS_LINUX
+		constexpr int protection = PROT_READ | PROT_WRITE;
+		constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+		if (!useHugePages) {
+			void* slab = mmap(nullptr, size, protection, flags, -1, 0);
+			return slab == MAP_FAILED ? nullptr : slab;
+		}
+
+		void* slab = mmap(nullptr, size, protection, flags | MAP_HUGETLB, -1, 0);
+		if (slab != MAP_FAILED) return slab;
+
+		// No reserved huge pages. Transparent huge pages need an aligned range, so map
+		// twice the size and cut off the excess.
+		void* range = mmap(nullptr, size * 2, protection, flags, -1, 0);
+		if (range == MAP_FAILED) return nullptr;
+
+		auto* begin = static_cast<suc::sbyte*>(range);
+		auto* aligned = begin + (size - reinterpret_cast<uintptr_t>(begin) % size) % size;
+		if (aligned > begin) munmap(begin, aligned - begin);
+		if (aligned + size < begin + size * 2) munmap(aligned + size, begin + size * 2 - (aligned + size));
+
+		madvise(aligned, size, MADV_HUGEPAGE);
+		return aligned;
+#elif defined(OS_IS_WINDOWS)
+		return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#endif
+	}
+} // anonymous namespace
+
+
+
+auto suc::BufferPool::getLocal() -> BufferPool&
+{
+	// The depot must outlive every thread's pool
+	getDepot();
+
+	thread_local BufferPool pool;
+	return pool;
+}
+
+
+void suc::BufferPool::setUseHugePages(bool enable) noexcept
+{
+	useHugePages = enable;
+}
+
+
+suc::BufferPool::~BufferPool() noexcept
+{
+	for (size_t i = 0; i < CLASS_COUNT; i++) {
+		release(i, freeLists[i].count);
+	}
+}
+
+
+auto suc::BufferPool::allocate(size_t size) -> void*
+{
+	if (size > MAX_POOLED_SIZE)
+	{
+		misses++;
+		return ::operator new(size);
+	}
+
+	const size_t classIndex = getClassIndex(size);
+	auto& list = freeLists[classIndex];
+	if (list.head == nullptr) {
+		refill(classIndex);
+	}
+	else {
+		hits++;
+	}
+
+	FreeBlock* block = list.head;
+	list.head = block->next;
+	list.count--;
+
+	return block;
+}
+
+
+void suc::BufferPool::deallocate(void* block, size_t size) noexcept
+{
+	if (size > MAX_POOLED_SIZE)
+	{
+		::operator delete(block);
+		return;
+	}
+
+	const size_t classIndex = getClassIndex(size);
+	auto& list = freeLists[classIndex];
+	list.head = new (block) FreeBlock{ list.head };
+	list.count++;
+
+	// Don't hoard blocks that other threads may need
+	if (list.count > getBatchCount(classIndex) * 2) {
+		release(classIndex, getBatchCount(classIndex));
+	}
+}
+
+
+auto suc::BufferPool::getStats() const noexcept -> Stats
+{
+	return { hits, misses, residentBytes };
+}
+
+
+void suc::BufferPool::refill(size_t classIndex)
+{
+	misses++;
+
+	const size_t blockSize = SIZE_CLASSES[classIndex];
+	auto& depot = getDepot();
+	auto& list = freeLists[classIndex];
+
+	std::lock_guard lock(depot.mutex);
+	auto& blocks = depot.blocks[classIndex];
+	if (blocks.empty())
+	{
+		// Reserve room for every block of the class so that release() never allocates
+		blocks.reserve(depot.carvedBlocks[classIndex] + SLAB_SIZE / blockSize);
+
+		auto* slab = static_cast<sbyte*>(mapSlab());
+		if (slab == nullptr) {
+			throw memory_error("Unable to map a slab of " + std::to_string(SLAB_SIZE) + " bytes.");
+		}
+		residentBytes += SLAB_SIZE;
+		depot.carvedBlocks[classIndex] += SLAB_SIZE / blockSize;
+
+		for (size_t offset = SLAB_SIZE; offset > 0; offset -= blockSize) {
+			blocks.push_back(slab + offset - blockSize);
+		}
+	}
+
+	const size_t count = std::min(blocks.size(), getBatchCount(classIndex));
+	for (size_t i = 0; i < count; i++)
+	{
+		list.head = new (blocks.back()) FreeBlock{ list.head };
+		blocks.pop_back();
+	}
+	list.count += count;
+}
+
+
+void suc::BufferPool::release(size_t classIndex, size_t count) noexcept
+{
+	auto& depot = getDepot();
+	auto& list = freeLists[classIndex];
+
+	std::lock_guard lock(depot.mutex);
+	for (; count > 0 && list.head != nullptr; count--)
+	{
+		FreeBlock* block = list.head;
+		list.head = block->next;
+		list.count--;
+		depot.blocks[classIndex].push_back(block);
+	}
+}
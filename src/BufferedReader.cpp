@@ -0,0 +1,129 @@
+#include "BufferedReader.h"
+
+#include <algorithm>
+
+#include "Internals.h"
+
+
+
+suc::BufferedReader::BufferedReader(ClientSocket& socket, size_t maxBufferSize)
+	:
+	socket(socket),
+	maxBufferSize(std::max(maxBufferSize, INITIAL_BUFFER_SIZE))
+{
+}
+
+
+auto suc::BufferedReader::readExact(size_t size, int timeout) -> std::optional<std::string_view>
+{
+	if (size > maxBufferSize) {
+		throw value_error("Cannot read " + std::to_string(size) + " bytes at once, the maximum is "
+						  + std::to_string(maxBufferSize) + " bytes.");
+	}
+
+	const auto deadline = makeDeadline(timeout);
+	while (getBufferedSize() < size)
+	{
+		if (!fill(size, deadline)) {
+			return std::nullopt;
+		}
+	}
+
+	const auto result = getUnread().substr(0, size);
+	begin += size;
+
+	return result;
+}
+
+
+auto suc::BufferedReader::readUntil(std::string_view delimiter, int timeout) -> std::optional<std::string_view>
+{
+	const auto deadline = makeDeadline(timeout);
+	size_t scanned = 0; // Bytes of the unread data that cannot start the delimiter
+	while (true)
+	{
+		const auto unread = getUnread();
+		const size_t pos = findSequence(unread, delimiter, scanned);
+		if (pos != std::string_view::npos)
+		{
+			begin += pos + delimiter.size();
+			return unread.substr(0, pos);
+		}
+
+		scanned = resumeSequenceSearch(unread.size(), delimiter.size());
+		if (unread.size() >= maxBufferSize) {
+			throw value_error("No delimiter within " + std::to_string(maxBufferSize) + " bytes.");
+		}
+		if (!fill(unread.size() + 1, deadline)) {
+			return std::nullopt;
+		}
+	}
+}
+
+
+auto suc::BufferedReader::peek(int timeout) -> std::string_view
+{
+	if (getBufferedSize() == 0) {
+		fill(1, makeDeadline(timeout));
+	}
+
+	return getUnread();
+}
+
+
+void suc::BufferedReader::consume(size_t size) noexcept
+{
+	begin += std::min(size, getBufferedSize());
+}
+
+
+auto suc::BufferedReader::getBufferedSize() const noexcept -> size_t
+{
+	return end - begin;
+}
+
+
+auto suc::BufferedReader::getLastStatus() const noexcept -> RecvStatus
+{
+	return lastStatus;
+}
+
+
+bool suc::BufferedReader::fill(size_t required, clock::time_point deadline)
+{
+	// Move the unread data to the front if it would not fit behind its current position
+	if (begin == end) {
+		begin = end = 0;
+	}
+	if (begin > 0 && (buffer.size() - begin < required || end == buffer.size()))
+	{
+		std::copy(buffer.begin() + begin, buffer.begin() + end, buffer.begin());
+		end -= begin;
+		begin = 0;
+	}
+	if (buffer.size() < required || end == buffer.size())
+	{
+		const size_t newSize = std::max({ required, buffer.size() * 2, INITIAL_BUFFER_SIZE });
+		buffer.resize(std::min(newSize, maxBufferSize));
+	}
+
+	int timeout = TIMEOUT_NEVER;
+	if (deadline != clock::time_point::max())
+	{
+		// Try once more without waiting if the deadline has passed
+		const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - clock::now());
+		timeout = static_cast<int>(std::max<long>(remaining.count(), TIMEOUT_INSTANT));
+	}
+
+	const auto result = socket.recvInto(std::as_writable_bytes(std::span(buffer)).subspan(end), timeout);
+	end += result.bytes;
+	lastStatus = result.status;
+
+	return result.status == RecvStatus::OK && result.bytes > 0;
+}
+
+
+auto suc::BufferedReader::getUnread() const noexcept -> std::string_view
+{
+	return { buffer.data() + begin, end - begin };
+}
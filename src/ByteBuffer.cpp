@@ -0,0 +1,547 @@
+#include "ByteBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "BufferPool.h"
+
+
+
+void suc::THROW_FAILED_MEM_ALLOC(size_t size)
+{
+	throw suc::memory_error("Unable to allocate " + std::to_string(size) + " bytes of memory.");
+}
+
+
+
+struct suc::ByteBuffer::Storage
+{
+	std::atomic<uint> references;
+	buf_size capacity; // Bytes behind the header
+
+	auto begin() noexcept -> sbyte* {
+		return reinterpret_cast<sbyte*>(this + 1);
+	}
+	auto end() noexcept -> sbyte* {
+		return begin() + capacity;
+	}
+};
+
+
+auto suc::ByteBuffer::Segment::headroom() const -> buf_size
+{
+	return static_cast<buf_size>(begin - storage->begin());
+}
+
+
+auto suc::ByteBuffer::Segment::tailroom() const -> buf_size
+{
+	return static_cast<buf_size>(storage->end() - (begin + length));
+}
+
+
+bool suc::ByteBuffer::Segment::isShared() const
+{
+	return storage->references.load(std::memory_order_acquire) > 1;
+}
+
+
+
+suc::ByteBuffer::ByteBuffer(buf_size size)
+{
+	if (size > 0U)
+	{
+		Segment& segment = appendSegment(size, 0U);
+		memset(segment.begin, 0, size);
+		segment.length = size;
+		_size = size;
+	}
+}
+
+
+suc::ByteBuffer::ByteBuffer(buf_size size, const void* source)
+{
+	append(source, size);
+}
+
+
+auto suc::ByteBuffer::create(buf_size capacity, buf_size headroom) -> ByteBuffer
+{
+	ByteBuffer result;
+	result.appendSegment(capacity, headroom);
+
+	return result;
+}
+
+
+suc::ByteBuffer::ByteBuffer(const ByteBuffer& other)
+	:
+	_size(other._size),
+	segments(other.segments)
+{
+	for (auto& segment : segments) {
+		acquire(segment.storage);
+	}
+}
+
+
+suc::ByteBuffer& suc::ByteBuffer::operator=(const ByteBuffer& rhs)
+{
+	if (this != &rhs) {
+		*this = ByteBuffer(rhs);
+	}
+
+	return *this;
+}
+
+
+suc::ByteBuffer::ByteBuffer(ByteBuffer&& other) noexcept
+	:
+	_size(other._size),
+	segments(std::move(other.segments))
+{
+	// Invalidate other
+	other._size = 0U;
+	other.segments.clear();
+}
+
+
+suc::ByteBuffer& suc::ByteBuffer::operator=(ByteBuffer&& rhs) noexcept
+{
+	std::swap(_size, rhs._size);
+	std::swap(segments, rhs.segments);
+
+	// Invalidate other
+	rhs.clear();
+
+	return *this;
+}
+
+
+suc::ByteBuffer::~ByteBuffer() noexcept
+{
+	clear();
+}
+
+
+void* suc::ByteBuffer::data() const
+{
+	if (_size == 0U) {
+		return nullptr;
+	}
+
+	coalesce();
+	return segments.front().begin;
+}
+
+
+suc::ByteBuffer& suc::ByteBuffer::cpy(const void* source, buf_offset offset, buf_size size)
+{
+	checkRange(offset, size);
+	unshare();
+	coalesce();
+
+	memcpy(static_cast<ubyte*>(data()) + offset, source, size);
+	return *this;
+}
+
+
+suc::ByteBuffer suc::ByteBuffer::makeCopy() const
+{
+	return makeCopyRange(0U, _size);
+}
+
+
+void* suc::ByteBuffer::makeRawCopy() const
+{
+	return makeRawCopyRange(0U, _size);
+}
+
+
+suc::ByteBuffer suc::ByteBuffer::makeCopyRange(buf_offset offset, buf_size size) const
+{
+	checkRange(offset, size);
+
+	ByteBuffer result;
+	if (size > 0U)
+	{
+		Segment& segment = result.appendSegment(size, 0U);
+		copyTo(offset, size, segment.begin);
+		segment.length = size;
+		result._size = size;
+	}
+
+	return result;
+}
+
+
+void* suc::ByteBuffer::makeRawCopyRange(buf_offset offset, buf_size size) const
+{
+	checkRange(offset, size);
+
+	void* buf = malloc(size);
+	if (buf == nullptr) {
+		THROW_FAILED_MEM_ALLOC(size);
+	}
+	copyTo(offset, size, buf);
+	return buf;
+}
+
+
+void suc::ByteBuffer::copyTo(buf_offset offset, buf_size size, void* dest) const
+{
+	checkRange(offset, size);
+
+	auto* out = static_cast<sbyte*>(dest);
+	for (const auto& segment : segments)
+	{
+		if (size == 0U) break;
+		if (offset >= segment.length)
+		{
+			offset -= segment.length;
+			continue;
+		}
+
+		const buf_size length = std::min(segment.length - offset, size);
+		memcpy(out, segment.begin + offset, length);
+		out += length;
+		size -= length;
+		offset = 0U;
+	}
+}
+
+
+auto suc::ByteBuffer::find(std::string_view pattern, buf_offset from) const -> std::optional<buf_offset>
+{
+	if (pattern.empty()) {
+		return from <= _size ? std::optional(from) : std::nullopt;
+	}
+
+	buf_offset segmentStart = 0U;
+	for (size_t i = 0; i < segments.size(); i++)
+	{
+		const Segment& segment = segments[i];
+		const std::string_view bytes(segment.begin, segment.length);
+		size_t index = from > segmentStart ? std::min(from - segmentStart, segment.length) : 0U;
+
+		// Find candidates by their first byte, then compare the rest
+		while ((index = findByte(bytes, pattern.front(), index)) != std::string_view::npos)
+		{
+			const buf_offset offset = segmentStart + index;
+			if (offset + pattern.size() > _size) {
+				return std::nullopt;
+			}
+			if (matchesAt(i, segment.begin + index, pattern)) {
+				return offset;
+			}
+			index++;
+		}
+		segmentStart += segment.length;
+	}
+
+	return std::nullopt;
+}
+
+
+void suc::ByteBuffer::resize(buf_size size)
+{
+	clear();
+	if (size > 0U)
+	{
+		appendSegment(size, 0U).length = size;
+		_size = size;
+	}
+}
+
+
+auto suc::ByteBuffer::slice(buf_offset offset, buf_size size) const -> ByteBuffer
+{
+	checkRange(offset, size);
+
+	ByteBuffer result;
+	result.segments.reserve(segments.size());
+	for (const auto& segment : segments)
+	{
+		if (size == 0U) break;
+		if (offset >= segment.length)
+		{
+			offset -= segment.length;
+			continue;
+		}
+
+		const buf_size length = std::min(segment.length - offset, size);
+		acquire(segment.storage);
+		result.segments.push_back({ segment.storage, segment.begin + offset, length });
+		result._size += length;
+
+		size -= length;
+		offset = 0U;
+	}
+
+	return result;
+}
+
+
+void suc::ByteBuffer::trimStart(buf_size size)
+{
+	checkRange(0U, size);
+	_size -= size;
+
+	auto it = segments.begin();
+	for (; it != segments.end() && size >= it->length && size > 0U; it++)
+	{
+		size -= it->length;
+		release(it->storage);
+	}
+	segments.erase(segments.begin(), it);
+
+	if (size > 0U)
+	{
+		segments.front().begin += size;
+		segments.front().length -= size;
+	}
+}
+
+
+void suc::ByteBuffer::trimEnd(buf_size size)
+{
+	checkRange(0U, size);
+	_size -= size;
+
+	while (size > 0U && size >= segments.back().length)
+	{
+		size -= segments.back().length;
+		release(segments.back().storage);
+		segments.pop_back();
+	}
+	if (size > 0U) {
+		segments.back().length -= size;
+	}
+}
+
+
+void suc::ByteBuffer::prepend(const void* source, buf_size size)
+{
+	if (size == 0U) return;
+
+	if (segments.empty() || segments.front().isShared() || segments.front().headroom() < size)
+	{
+		// Place the data at the end of the new segment to leave headroom for the next call
+		segments.reserve(segments.size() + 1);
+		Storage* storage = allocateStorage(size);
+		segments.insert(segments.begin(), { storage, storage->end(), 0U });
+	}
+
+	Segment& front = segments.front();
+	front.begin -= size;
+	front.length += size;
+	memcpy(front.begin, source, size);
+	_size += size;
+}
+
+
+void suc::ByteBuffer::append(const void* source, buf_size size)
+{
+	if (size == 0U) return;
+
+	auto space = preallocate(size);
+	memcpy(space.data(), source, size);
+	postallocate(size);
+}
+
+
+void suc::ByteBuffer::append(ByteBuffer other)
+{
+	if (other._size == 0U) return;
+
+	// An empty segment from create() is of no use in the middle of the chain
+	if (!segments.empty() && segments.back().length == 0U)
+	{
+		release(segments.back().storage);
+		segments.pop_back();
+	}
+
+	segments.insert(segments.end(), other.segments.begin(), other.segments.end());
+	_size += other._size;
+
+	// The references have been moved
+	other.segments.clear();
+	other._size = 0U;
+}
+
+
+auto suc::ByteBuffer::preallocate(buf_size minSize) -> std::span<std::byte>
+{
+	if (segments.empty() || segments.back().isShared() || segments.back().tailroom() < minSize)
+	{
+		if (!segments.empty() && segments.back().length == 0U)
+		{
+			release(segments.back().storage);
+			segments.pop_back();
+		}
+		appendSegment(minSize, 0U);
+	}
+
+	Segment& back = segments.back();
+	return { reinterpret_cast<std::byte*>(back.begin + back.length), back.tailroom() };
+}
+
+
+void suc::ByteBuffer::postallocate(buf_size size)
+{
+	assert(!segments.empty() && size <= segments.back().tailroom());
+
+	segments.back().length += size;
+	_size += size;
+}
+
+
+void suc::ByteBuffer::coalesce() const
+{
+	if (segments.size() <= 1U) return;
+
+	const buf_size headroom = segments.front().headroom();
+	Storage* storage = allocateStorage(headroom + _size);
+	sbyte* begin = storage->begin() + headroom;
+	copyTo(0U, _size, begin);
+
+	for (auto& segment : segments) {
+		release(segment.storage);
+	}
+	segments.resize(1);
+	segments.front() = { storage, begin, _size };
+}
+
+
+void suc::ByteBuffer::unshare()
+{
+	if (!isShared()) return;
+
+	*this = makeCopy();
+}
+
+
+bool suc::ByteBuffer::isShared() const
+{
+	return std::any_of(segments.begin(), segments.end(), [](const Segment& segment) {
+		return segment.isShared();
+	});
+}
+
+
+bool suc::ByteBuffer::isChained() const
+{
+	return segments.size() > 1U;
+}
+
+
+auto suc::ByteBuffer::getSegmentCount() const -> size_t
+{
+	return segments.size();
+}
+
+
+auto suc::ByteBuffer::getHeadroom() const -> buf_size
+{
+	return segments.empty() ? 0U : segments.front().headroom();
+}
+
+
+auto suc::ByteBuffer::getTailroom() const -> buf_size
+{
+	return segments.empty() ? 0U : segments.back().tailroom();
+}
+
+
+auto suc::ByteBuffer::getSegments() const -> std::vector<iovec>
+{
+	std::vector<iovec> result;
+	result.reserve(segments.size());
+	for (const auto& segment : segments)
+	{
+		if (segment.length > 0U) {
+			result.push_back({ segment.begin, segment.length });
+		}
+	}
+
+	return result;
+}
+
+
+auto suc::ByteBuffer::allocateStorage(buf_size capacity) -> Storage*
+{
+	// Round up to the pool's block size; the excess becomes tailroom
+	const size_t blockSize = BufferPool::getBlockSize(sizeof(Storage) + capacity);
+	try {
+		void* block = BufferPool::getLocal().allocate(blockSize);
+		return new (block) Storage{ 1U, blockSize - sizeof(Storage) };
+	}
+	catch (const std::bad_alloc&) {
+		THROW_FAILED_MEM_ALLOC(blockSize);
+	}
+	return nullptr;
+}
+
+
+void suc::ByteBuffer::acquire(Storage* storage) noexcept
+{
+	storage->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void suc::ByteBuffer::release(Storage* storage) noexcept
+{
+	if (storage->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		const size_t blockSize = sizeof(Storage) + storage->capacity;
+		storage->~Storage();
+		BufferPool::getLocal().deallocate(storage, blockSize);
+	}
+}
+
+
+auto suc::ByteBuffer::appendSegment(buf_size capacity, buf_size headroom) -> Segment&
+{
+	segments.reserve(segments.size() + 1);
+	Storage* storage = allocateStorage(headroom + capacity);
+	segments.push_back({ storage, storage->begin() + headroom, 0U });
+
+	return segments.back();
+}
+
+
+bool suc::ByteBuffer::matchesAt(size_t segmentIndex, const sbyte* pos, std::string_view pattern) const
+{
+	while (!pattern.empty() && segmentIndex < segments.size())
+	{
+		const Segment& segment = segments[segmentIndex++];
+		if (pos == nullptr) pos = segment.begin;
+
+		const size_t length = std::min(pattern.size(), static_cast<size_t>(segment.begin + segment.length - pos));
+		if (memcmp(pos, pattern.data(), length) != 0) {
+			return false;
+		}
+		pattern.remove_prefix(length);
+		pos = nullptr;
+	}
+
+	return pattern.empty();
+}
+
+
+void suc::ByteBuffer::checkRange(buf_offset offset, buf_size size) const
+{
+	if (offset > _size || size > _size - offset) {
+		throw value_error("Specified offset and size exceed buffer capacity.");
+	}
+}
+
+
+void suc::ByteBuffer::clear() noexcept
+{
+	for (auto& segment : segments) {
+		release(segment.storage);
+	}
+	segments.clear();
+	_size = 0U;
+}
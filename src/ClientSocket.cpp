@@ -1,12 +1,125 @@
 #include "ClientSocket.h"
 
+#include <algorithm>
+#include <array>
+
+#include "ByteBuffer.h"
 #include "Internals.h"
 
+#ifdef OS_IS_LINUX
+	#include <csignal>
+	#include <pthread.h>
+#endif
+
+
+
+namespace
+{
+#ifdef OS_IS_LINUX
+	/*
+	sendfile(2) has no MSG_NOSIGNAL. Blocks SIGPIPE on the calling thread and discards one
+	that has been raised in the meantime, so that a closed connection results in EPIPE
+	instead of terminating the process. */
+	class SigpipeBlocker
+	{
+	public:
+		SigpipeBlocker() noexcept
+		{
+			sigemptyset(&sigpipe);
+			sigaddset(&sigpipe, SIGPIPE);
+
+			// A SIGPIPE that is already pending is not ours to discard
+			sigset_t pending;
+			sigpending(&pending);
+			wasPending = sigismember(&pending, SIGPIPE) == 1;
+			pthread_sigmask(SIG_BLOCK, &sigpipe, &previousMask);
+		}
+
+		~SigpipeBlocker() noexcept
+		{
+			if (!wasPending)
+			{
+				const int savedErrno = errno;
+				const timespec zero{};
+				while (sigtimedwait(&sigpipe, nullptr, &zero) == -1 && errno == EINTR);
+				errno = savedErrno;
+			}
+			pthread_sigmask(SIG_SETMASK, &previousMask, nullptr);
+		}
+
+		SigpipeBlocker(const SigpipeBlocker&) = delete;
+		SigpipeBlocker(SigpipeBlocker&&) noexcept = delete;
+		SigpipeBlocker& operator=(const SigpipeBlocker&) = delete;
+		SigpipeBlocker& operator=(SigpipeBlocker&&) noexcept = delete;
+
+	private:
+		sigset_t sigpipe;
+		sigset_t previousMask;
+		bool wasPending;
+	};
+#endif
+
+	/*
+	Receives until a read leaves room in the memory that it was given, i.e. until the
+	socket has no more data for now. getSpace() returns writable memory behind the data
+	that has been read so far, commit() is called with the number of bytes written to it. */
+	template<typename GetSpace, typename Commit>
+	auto recvUntilDrained(suc::ClientSocket& socket, int timeout, GetSpace getSpace, Commit commit)
+		-> suc::RecvResult
+	{
+		std::span<std::byte> space = getSpace();
+		auto result = socket.recvInto(space, timeout);
+		commit(result.bytes);
+
+		size_t size = result.bytes;
+		while (result.status == suc::RecvStatus::OK && result.bytes == space.size())
+		{
+			space = getSpace();
+			result = socket.recvInto(space, suc::TIMEOUT_INSTANT);
+			commit(result.bytes);
+			size += result.bytes;
+		}
+		if (size > 0) {
+			socket.getRecvBufferSizer().record(size);
+		}
+
+		// Report closed connections and timeouts on the next call if data has been read
+		if (size > 0) {
+			return { size, suc::RecvStatus::OK };
+		}
+		return { 0, result.status };
+	}
+
+	/*
+	Reads everything that is available into a resizable container, reusing its capacity
+	and growing it only if it fills up. New buffers start at the predicted size. */
+	template<typename Container>
+	auto recvAvailable(suc::ClientSocket& socket, Container& buf, int timeout) -> suc::RecvResult
+	{
+		buf.resize(std::max(buf.capacity(), socket.getRecvBufferSizer().nextSize()));
+		size_t size = 0;
+
+		const auto result = recvUntilDrained(socket, timeout,
+			[&buf, &size]() {
+				if (size == buf.size()) {
+					buf.resize(buf.size() * 2);
+				}
+				return std::as_writable_bytes(std::span(buf)).subspan(size);
+			},
+			[&size](size_t bytes) { size += bytes; }
+		);
+		buf.resize(size);
+
+		return result;
+	}
+} // anonymous namespace
+
 
 
 suc::ClientSocket::ClientSocket(SOCKET socket) noexcept
 	:
-	socket(socket)
+	socket(socket),
+	_isClosed(socket == INVALID_SOCKET)
 {
 }
 
@@ -28,6 +141,7 @@ suc::ClientSocket::ClientSocket(ClientSocket&& other) noexcept
 {
 	std::swap(socket, other.socket);
 	std::swap(_isClosed, other._isClosed);
+	std::swap(recvBufferSizer, other.recvBufferSizer);
 }
 
 
@@ -35,6 +149,7 @@ suc::ClientSocket& suc::ClientSocket::operator=(ClientSocket&& rhs) noexcept
 {
 	std::swap(socket, rhs.socket);
 	std::swap(_isClosed, rhs._isClosed);
+	std::swap(recvBufferSizer, rhs.recvBufferSizer);
 
 	return *this;
 }
@@ -48,88 +163,353 @@ bool suc::ClientSocket::connect(std::string ip, int port, int family)
 	}
 
 	// Create a new socket
-    addrinfo* ptr = translateAddress(ip, port, family, SOCK_STREAM, IPPROTO_TCP, 0);
-	int iResult = 0;
+	auto addresses = Resolver::getDefault().resolve(ip, port, family);
+	int lastError = EADDRNOTAVAIL;
 
-	for (; ptr != nullptr; ptr = ptr->ai_next)
+	for (const auto& address : *addresses)
 	{
 		// Create socket
-		socket = suc_socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+		socket = suc_socket(address.family, address.type, address.protocol);
 		if (socket == INVALID_SOCKET)
 		{
 			// Do nothing, just try the next address
+			lastError = getLastError();
 			continue;
 		}
 
-		iResult = suc_connect(socket, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen));
-		if (iResult != SOCKET_ERROR)
+		if (suc_connect(socket, address.getSockaddr(), address.length) != SOCKET_ERROR)
 		{
 			_isClosed = false;
 			return true;
 		}
 
-		handleLastError();
+		// Try the next address
+		lastError = getLastError();
+		suc_close(socket);
+		socket = INVALID_SOCKET;
 	}
 
 	// No returned addresses were valid
-	handleLastError();
+	handleError(lastError);
 }
 
 
-void suc::ClientSocket::send(const void* buf, size_t size)
+bool suc::ClientSocket::connect(
+	std::string ip, int port, int family,
+	std::chrono::milliseconds timeout,
+	std::chrono::milliseconds attemptDelay)
 {
-	int writtenBytes = suc_send(socket, buf, size, 0);
-	if (writtenBytes < 0)
-		handleLastError();
+	using clock = std::chrono::steady_clock;
+
+	if (!_isClosed) { close(); }
+	if (ip.empty()) {
+		ip = ADDR_LOCALHOST_4;
+	}
+
+	const auto deadline = clock::now() + timeout;
+	auto addresses = Resolver::getDefault().resolve(ip, port, family);
+
+	/*
+	>>> RFC 8305, 4
+	[...] the client SHOULD modify the ordered list to interleave
+	address families.  Whichever address family is first in the list
+	should be followed by an address of the other address family [...]
+	<<< */
+	std::vector<const ResolvedAddress*> primary;
+	std::vector<const ResolvedAddress*> secondary;
+	for (const auto& address : *addresses)
+	{
+		if (primary.empty() || address.family == primary.front()->family)
+			primary.push_back(&address);
+		else
+			secondary.push_back(&address);
+	}
+	std::vector<const ResolvedAddress*> candidates;
+	for (size_t i = 0; i < std::max(primary.size(), secondary.size()); i++)
+	{
+		if (i < primary.size())	  candidates.push_back(primary[i]);
+		if (i < secondary.size()) candidates.push_back(secondary[i]);
+	}
 
-	assert(writtenBytes == static_cast<int>(size));
+	std::vector<pollfd> attempts;
+	auto nextCandidate = candidates.begin();
+	auto nextAttemptTime = clock::now();
+	SOCKET winner = INVALID_SOCKET;
+	int lastError = EADDRNOTAVAIL;
+
+	while (winner == INVALID_SOCKET)
+	{
+		const auto now = clock::now();
+		if (now >= deadline) break;
+
+		// Start the next attempt when the previous one had its head start or has failed
+		if (nextCandidate != candidates.end() && (now >= nextAttemptTime || attempts.empty()))
+		{
+			const ResolvedAddress* addr = *nextCandidate++;
+			SOCKET s = suc_socket(addr->family, addr->type, addr->protocol);
+			if (s == INVALID_SOCKET || suc_set_nonblocking(s, true) == -1)
+			{
+				lastError = getLastError();
+				if (s != INVALID_SOCKET) suc_close(s);
+				continue;
+			}
+
+			if (suc_connect(s, addr->getSockaddr(), addr->length) == 0) {
+				winner = s;
+			}
+			else if (getLastError() == EINPROGRESS) {
+				attempts.push_back({ s, POLLOUT, 0 });
+				nextAttemptTime = now + attemptDelay;
+			}
+			else {
+				lastError = getLastError();
+				suc_close(s);
+			}
+			continue;
+		}
+
+		// All candidates have failed
+		if (attempts.empty()) break;
+
+		auto wakeup = deadline;
+		if (nextCandidate != candidates.end()) {
+			wakeup = std::min(wakeup, nextAttemptTime);
+		}
+		const auto waitTime = std::chrono::ceil<std::chrono::milliseconds>(wakeup - now);
+
+		int ready = suc_poll(attempts.data(), attempts.size(), static_cast<int>(waitTime.count()));
+		if (ready == -1 && getLastError() != EINTR)
+		{
+			lastError = getLastError();
+			break;
+		}
+
+		for (auto it = attempts.begin(); ready > 0 && it != attempts.end(); )
+		{
+			if (it->revents == 0) {
+				it++;
+				continue;
+			}
+
+			int error = 0;
+			int errorSize = sizeof(error);
+			if (suc_getsockopt(it->fd, SOL_SOCKET, SO_ERROR, &error, &errorSize) == -1) {
+				error = getLastError();
+			}
+
+			if (error == 0)
+			{
+				winner = it->fd;
+				attempts.erase(it);
+				break;
+			}
+
+			// Failed attempts don't delay the next one
+			lastError = error;
+			suc_close(it->fd);
+			it = attempts.erase(it);
+			nextAttemptTime = now;
+		}
+	}
+
+	for (const auto& attempt : attempts) {
+		suc_close(attempt.fd);
+	}
+
+	if (winner != INVALID_SOCKET)
+	{
+		suc_set_nonblocking(winner, false);
+		socket = winner;
+		_isClosed = false;
+		return true;
+	}
+	if (clock::now() >= deadline) {
+		return false;
+	}
+
+	handleError(lastError);
 }
 
 
-auto suc::ClientSocket::recv(int timeout) -> std::vector<sbyte>
+void suc::ClientSocket::send(const void* buf, size_t size)
 {
-	// Wait for the timeout
-	if (!hasData(timeout)) {
-		return {};
+	// Short writes happen on interrupted or non-blocking sockets
+	const auto* data = static_cast<const sbyte*>(buf);
+	while (size > 0)
+	{
+		int writtenBytes = suc_send(socket, data, size, MSG_NOSIGNAL);
+		if (writtenBytes < 0)
+		{
+			if (getLastError() == EINTR) continue;
+			if (getLastError() == EAGAIN || getLastError() == EWOULDBLOCK)
+			{
+				waitUntilWritable();
+				continue;
+			}
+			handleLastError();
+		}
+
+		data += writtenBytes;
+		size -= static_cast<size_t>(writtenBytes);
 	}
+}
+
+
+void suc::ClientSocket::send(std::span<const iovec> buffers)
+{
+	// The kernel takes a limited number of buffers per call, and short writes
+	// require adjusting the first buffer. Work on a copy of a window of them.
+	std::array<iovec, SUC_MAX_IOV> window;
+	size_t next = 0;
+	size_t windowSize = 0;
+	size_t windowStart = 0;
 
-	std::vector<sbyte> buf(STANDARD_BUF_SIZE);
-	int readBytes = 0;
 	while (true)
 	{
-		int read = suc_recv(socket, buf.data() + readBytes, buf.size() - readBytes, 0);
-		if (read == 0)
+		if (windowStart == windowSize)
+		{
+			windowStart = 0;
+			windowSize = std::min(buffers.size() - next, window.size());
+			if (windowSize == 0) break;
+			std::copy_n(buffers.begin() + static_cast<ptrdiff_t>(next), windowSize, window.begin());
+			next += windowSize;
+		}
+
+		int written = suc_sendv(socket, window.data() + windowStart, windowSize - windowStart, MSG_NOSIGNAL);
+		if (written < 0)
+		{
+			if (getLastError() == EINTR) continue;
+			if (getLastError() == EAGAIN || getLastError() == EWOULDBLOCK)
+			{
+				waitUntilWritable();
+				continue;
+			}
 			handleLastError();
+		}
 
-		readBytes += read;
-		if (readBytes < static_cast<int>(buf.size()))
-			break;
+		// Skip the buffers that have been written completely
+		auto remaining = static_cast<size_t>(written);
+		while (windowStart < windowSize && remaining >= window[windowStart].iov_len)
+		{
+			remaining -= window[windowStart].iov_len;
+			windowStart++;
+		}
+		if (remaining > 0)
+		{
+			auto& partial = window[windowStart];
+			partial.iov_base = static_cast<char*>(partial.iov_base) + remaining;
+			partial.iov_len -= remaining;
+		}
+	}
+}
 
-		buf.resize(buf.size() * 2);
+
+void suc::ClientSocket::sendFile(int fd, ulong offset, size_t length)
+{
+#ifdef OS_IS_LINUX
+	const SigpipeBlocker blocker;
+#endif
+	while (length > 0)
+	{
+		long sent = suc_sendfile(socket, fd, &offset, length);
+		if (sent == -1)
+		{
+			if (getLastError() == EINTR) continue;
+			if (getLastError() == EAGAIN || getLastError() == EWOULDBLOCK)
+			{
+				waitUntilWritable();
+				continue;
+			}
+			handleLastError();
+		}
+		if (sent == 0) {
+			throw value_error("The file ends " + std::to_string(length) + " bytes before the requested range.");
+		}
+
+		length -= static_cast<size_t>(sent);
 	}
+}
+
+
+auto suc::ClientSocket::recv(int timeout) -> std::vector<sbyte>
+{
+	std::vector<sbyte> buf;
+	recvAvailable(*this, buf, timeout);
 
-	buf.resize(static_cast<size_t>(readBytes));
 	return buf;
 }
 
 
-bool suc::ClientSocket::hasData(int timeout) const
+auto suc::ClientSocket::recvInto(std::span<std::byte> buf, int timeout) -> RecvResult
 {
-	// select() is POSIX-standardized but I still wrote a separate implementation
-	// for it. I shall look into this.
-	fd_set read{};
-	FD_SET(socket, &read);
+	// Try to read right away, the poll() is only needed if no data is available
+	bool hasWaited = false;
+	while (true)
+	{
+		int read = suc_recv(socket, buf.data(), buf.size(), MSG_DONTWAIT);
+		if (read > 0) {
+			return { static_cast<size_t>(read), RecvStatus::OK };
+		}
+		if (read == 0) {
+			return { 0, buf.empty() ? RecvStatus::OK : RecvStatus::CLOSED };
+		}
 
-	constexpr std::int32_t secondsFactor = 1000L;
-	timeval time{};
-	time.tv_usec = static_cast<std::int32_t>(timeout) % secondsFactor;
-	time.tv_sec = (static_cast<std::int32_t>(timeout) - time.tv_usec) / secondsFactor;
+		const int error = getLastError();
+		if (error == EINTR) continue;
+		if (error != EAGAIN && error != EWOULDBLOCK)
+			handleError(error);
 
-	timeval* t_ptr = &time;
-	if (timeout == -1)
-		t_ptr = nullptr;
+		if (hasWaited || timeout == TIMEOUT_INSTANT || !hasData(timeout)) {
+			return { 0, RecvStatus::TIMEOUT };
+		}
+		hasWaited = timeout != TIMEOUT_NEVER;
+	}
+}
 
-	int numSockets = suc_select(socket + 1, &read, nullptr, nullptr, t_ptr);
+
+auto suc::ClientSocket::recvString(std::string& str, int timeout) -> RecvResult
+{
+	return recvAvailable(*this, str, timeout);
+}
+
+
+auto suc::ClientSocket::recv(PooledBytes& buf, int timeout) -> RecvResult
+{
+	// Use the whole pool block instead of a part of it
+	buf.reserve(BufferPool::getBlockSize(recvBufferSizer.nextSize()));
+	return recvAvailable(*this, buf, timeout);
+}
+
+
+auto suc::ClientSocket::recv(ByteBuffer& buf, int timeout) -> RecvResult
+{
+	return recvUntilDrained(*this, timeout,
+		[this, &buf]() { return buf.preallocate(recvBufferSizer.nextSize()); },
+		[&buf](size_t bytes) { buf.postallocate(bytes); }
+	);
+}
+
+
+void suc::ClientSocket::waitUntilWritable() const
+{
+	pollfd pfd{};
+	pfd.fd = socket;
+	pfd.events = POLLOUT;
+
+	if (suc_poll(&pfd, 1, TIMEOUT_NEVER) == -1 && getLastError() != EINTR)
+		handleLastError();
+}
+
+
+bool suc::ClientSocket::hasData(int timeout) const
+{
+	// poll() instead of select() because an fd_set cannot hold descriptors
+	// beyond FD_SETSIZE.
+	pollfd pfd{};
+	pfd.fd = socket;
+	pfd.events = POLLIN;
+
+	int numSockets = suc_poll(&pfd, 1, timeout);
 	if (numSockets == -1)
 		handleLastError();
 
@@ -161,11 +541,30 @@ void suc::ClientSocket::send(const std::string& str)
 }
 
 
+void suc::ClientSocket::send(const ByteBuffer& buf)
+{
+	send(buf.getSegments());
+}
+
+
+auto suc::ClientSocket::asyncRecv(std::span<sbyte> buf) -> RecvAwaitable
+{
+	return { socket, buf };
+}
+
+
+auto suc::ClientSocket::asyncSend(std::span<const sbyte> data) -> SendAwaitable
+{
+	return { socket, data };
+}
+
+
 std::string suc::ClientSocket::recvString(int timeout)
 {
-	auto result = recv(timeout);
+	std::string str;
+	recvString(str, timeout);
 
-	return std::string{ result.data(), result.size() };
+	return str;
 }
 
 
@@ -173,3 +572,15 @@ bool suc::ClientSocket::isClosed() const noexcept
 {
 	return _isClosed;
 }
+
+
+auto suc::ClientSocket::getRecvBufferSizer() noexcept -> AdaptiveBufferSizer&
+{
+	return recvBufferSizer;
+}
+
+
+auto suc::ClientSocket::getNativeHandle() const noexcept -> SOCKET
+{
+	return socket;
+}
@@ -0,0 +1,226 @@
+#include "ConnectionPool.h"
+
+#include "Internals.h"
+
+
+
+auto suc::ConnectionPool::EndpointHash::operator()(const Endpoint& endpoint) const noexcept -> size_t
+{
+	size_t hash = std::hash<std::string>{}(endpoint.host);
+	hash ^= std::hash<int>{}(endpoint.port) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<int>{}(endpoint.family) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+	return hash;
+}
+
+
+suc::ConnectionPool::ConnectionPool(ConnectionPoolOptions options)
+	:
+	options(options)
+{
+}
+
+
+auto suc::ConnectionPool::checkout(const std::string& host, int port, int family) -> Connection
+{
+	size_t endpoint;
+	{
+		std::lock_guard lock(mutex);
+		const auto now = clock::now();
+		evictIdleLocked(now);
+
+		auto [it, inserted] = endpointIndices.try_emplace({ host, port, family }, idleConnections.size());
+		if (inserted) {
+			idleConnections.emplace_back();
+		}
+		endpoint = it->second;
+
+		// Most recently returned first, it is the least likely to have timed out remotely
+		auto& idle = idleConnections[endpoint];
+		while (!idle.empty())
+		{
+			ClientSocket socket = std::move(idle.back().socket);
+			idle.pop_back();
+			idleCount--;
+
+			bool healthy = false;
+			try {
+				healthy = !socket.hasData(TIMEOUT_INSTANT);
+			}
+			catch (const suc_error&) {}
+
+			if (healthy)
+			{
+				activeCount++;
+				reused++;
+				return Connection(*this, endpoint, std::move(socket), true);
+			}
+			discarded++;
+		}
+
+		if (idleCount + activeCount >= options.maxTotal && !closeLeastRecentlyUsed()) {
+			throw runtime_error("Connection pool limit of " + std::to_string(options.maxTotal)
+								+ " connections reached.");
+		}
+
+		// Reserve the slot while connecting without the lock
+		activeCount++;
+	}
+
+	try {
+		ClientSocket socket;
+		socket.connect(host, port, family);
+
+		std::lock_guard lock(mutex);
+		created++;
+		return Connection(*this, endpoint, std::move(socket), false);
+	}
+	catch (...) {
+		std::lock_guard lock(mutex);
+		activeCount--;
+		throw;
+	}
+}
+
+
+void suc::ConnectionPool::evictIdle()
+{
+	std::lock_guard lock(mutex);
+	evictIdleLocked(clock::now());
+}
+
+
+void suc::ConnectionPool::clear()
+{
+	std::lock_guard lock(mutex);
+	for (auto& idle : idleConnections)
+	{
+		discarded += idle.size();
+		idle.clear();
+	}
+	idleCount = 0;
+}
+
+
+auto suc::ConnectionPool::getStats() const -> Stats
+{
+	std::lock_guard lock(mutex);
+	return { idleCount, activeCount, reused, created, discarded };
+}
+
+
+void suc::ConnectionPool::giveBack(size_t endpoint, ClientSocket socket) noexcept
+{
+	std::lock_guard lock(mutex);
+	activeCount--;
+	if (socket.isClosed()) {
+		return;
+	}
+
+	auto& idle = idleConnections[endpoint];
+	if (idle.size() >= options.maxIdlePerEndpoint)
+	{
+		discarded++;
+		return;
+	}
+
+	const auto now = clock::now();
+	idle.push_back({ std::move(socket), now });
+	idleCount++;
+	evictIdleLocked(now);
+}
+
+
+bool suc::ConnectionPool::closeLeastRecentlyUsed()
+{
+	std::deque<IdleConnection>* oldest = nullptr;
+	for (auto& idle : idleConnections)
+	{
+		if (!idle.empty() && (oldest == nullptr || idle.front().since < oldest->front().since)) {
+			oldest = &idle;
+		}
+	}
+	if (oldest == nullptr) {
+		return false;
+	}
+
+	oldest->pop_front();
+	idleCount--;
+	discarded++;
+
+	return true;
+}
+
+
+void suc::ConnectionPool::evictIdleLocked(clock::time_point now)
+{
+	for (auto& idle : idleConnections)
+	{
+		while (!idle.empty() && now - idle.front().since > options.idleTimeout)
+		{
+			idle.pop_front();
+			idleCount--;
+			discarded++;
+		}
+	}
+}
+
+
+
+// ------------------------ //
+//		Connection			//
+// ------------------------ //
+
+suc::ConnectionPool::Connection::Connection(
+	ConnectionPool& pool,
+	size_t endpoint,
+	ClientSocket socket,
+	bool reused) noexcept
+	:
+	pool(&pool),
+	endpoint(endpoint),
+	socket(std::move(socket)),
+	reused(reused)
+{
+}
+
+
+suc::ConnectionPool::Connection::Connection(Connection&& other) noexcept
+	:
+	pool(std::exchange(other.pool, nullptr)),
+	endpoint(other.endpoint),
+	socket(std::move(other.socket)),
+	reused(other.reused)
+{
+}
+
+
+suc::ConnectionPool::Connection::~Connection() noexcept
+{
+	if (pool != nullptr) {
+		pool->giveBack(endpoint, std::move(socket));
+	}
+}
+
+
+auto suc::ConnectionPool::Connection::operator=(Connection&& rhs) noexcept -> Connection&
+{
+	std::swap(pool, rhs.pool);
+	std::swap(endpoint, rhs.endpoint);
+	std::swap(socket, rhs.socket);
+	std::swap(reused, rhs.reused);
+
+	return *this;
+}
+
+
+void suc::ConnectionPool::Connection::discard()
+{
+	socket.close();
+}
+
+
+bool suc::ConnectionPool::Connection::isReused() const noexcept
+{
+	return reused;
+}
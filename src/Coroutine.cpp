@@ -0,0 +1,232 @@
+#include "Coroutine.h"
+
+#include "ClientSocket.h"
+#include "Internals.h"
+
+
+
+namespace
+{
+	/*
+	Coroutine type that runs eagerly and destroys its own frame on completion. */
+	struct DetachedTask
+	{
+		struct promise_type
+		{
+			auto get_return_object() const noexcept -> DetachedTask { return {}; }
+			auto initial_suspend() const noexcept -> std::suspend_never { return {}; }
+			auto final_suspend() const noexcept -> std::suspend_never { return {}; }
+			void return_void() const noexcept {}
+
+			void unhandled_exception() const noexcept
+			{
+				try {
+					throw;
+				}
+				catch (const std::exception& e) {
+					std::cerr << "In suc::spawn(): " << e.what() << '\n';
+				}
+			}
+		};
+	};
+
+	inline bool wouldBlock(int error)
+	{
+		return error == EAGAIN || error == EWOULDBLOCK;
+	}
+} // anonymous namespace
+
+
+
+void suc::spawn(Task<void> task)
+{
+	[](Task<void> task) -> DetachedTask {
+		co_await std::move(task);
+	}(std::move(task));
+}
+
+
+
+// ------------------------ //
+//		Recv awaitable		//
+// ------------------------ //
+
+suc::RecvAwaitable::RecvAwaitable(SOCKET socket, std::span<sbyte> buf) noexcept
+	:
+	buf(buf)
+{
+	this->socket = socket;
+	events = EventLoop::READABLE;
+	onReady = [](Waiter& waiter, EventLoop::event_flags) {
+		auto& self = static_cast<RecvAwaitable&>(waiter);
+		if (self.tryRecv()) {
+			self.awaiting.resume();
+		}
+		else {
+			EventLoop::getCurrent().wait(self);
+		}
+	};
+}
+
+
+bool suc::RecvAwaitable::await_ready()
+{
+	return tryRecv();
+}
+
+
+void suc::RecvAwaitable::await_suspend(std::coroutine_handle<> awaiting)
+{
+	this->awaiting = awaiting;
+	EventLoop::getCurrent().wait(*this);
+}
+
+
+auto suc::RecvAwaitable::await_resume() -> size_t
+{
+	if (result < 0) {
+		handleError(-result);
+	}
+
+	return static_cast<size_t>(result);
+}
+
+
+bool suc::RecvAwaitable::tryRecv()
+{
+	result = suc_recv(socket, buf.data(), buf.size(), MSG_DONTWAIT);
+	if (result == -1)
+	{
+		if (wouldBlock(getLastError())) return false;
+		result = -getLastError();
+	}
+
+	return true;
+}
+
+
+
+// ------------------------ //
+//		Send awaitable		//
+// ------------------------ //
+
+suc::SendAwaitable::SendAwaitable(SOCKET socket, std::span<const sbyte> data) noexcept
+	:
+	remaining(data)
+{
+	this->socket = socket;
+	events = EventLoop::WRITABLE;
+	onReady = [](Waiter& waiter, EventLoop::event_flags) {
+		auto& self = static_cast<SendAwaitable&>(waiter);
+		if (self.trySend()) {
+			self.awaiting.resume();
+		}
+		else {
+			EventLoop::getCurrent().wait(self);
+		}
+	};
+}
+
+
+bool suc::SendAwaitable::await_ready()
+{
+	return trySend();
+}
+
+
+void suc::SendAwaitable::await_suspend(std::coroutine_handle<> awaiting)
+{
+	this->awaiting = awaiting;
+	EventLoop::getCurrent().wait(*this);
+}
+
+
+void suc::SendAwaitable::await_resume()
+{
+	if (lastError != 0) {
+		handleError(lastError);
+	}
+}
+
+
+bool suc::SendAwaitable::trySend()
+{
+	while (!remaining.empty())
+	{
+		int written = suc_send(socket, remaining.data(), remaining.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (written == -1)
+		{
+			if (wouldBlock(getLastError())) return false;
+			lastError = getLastError();
+			return true;
+		}
+		remaining = remaining.subspan(static_cast<size_t>(written));
+	}
+
+	return true;
+}
+
+
+
+// ------------------------ //
+//		Accept awaitable	//
+// ------------------------ //
+
+suc::AcceptAwaitable::AcceptAwaitable(SOCKET listener) noexcept
+{
+	socket = listener;
+	events = EventLoop::READABLE;
+	onReady = [](Waiter& waiter, EventLoop::event_flags) {
+		auto& self = static_cast<AcceptAwaitable&>(waiter);
+		if (self.tryAccept()) {
+			self.awaiting.resume();
+		}
+		else {
+			EventLoop::getCurrent().wait(self);
+		}
+	};
+}
+
+
+bool suc::AcceptAwaitable::await_ready()
+{
+	// Don't wait for the event loop if a connection is already pending
+	return tryAccept();
+}
+
+
+void suc::AcceptAwaitable::await_suspend(std::coroutine_handle<> awaiting)
+{
+	this->awaiting = awaiting;
+	EventLoop::getCurrent().wait(*this);
+}
+
+
+auto suc::AcceptAwaitable::await_resume() -> ClientSocket
+{
+	if (lastError != 0) {
+		handleError(lastError);
+	}
+
+	return ClientSocket(accepted);
+}
+
+
+bool suc::AcceptAwaitable::tryAccept()
+{
+	sockaddr_storage clientAddress{};
+	int addressLength = static_cast<int>(sizeof(clientAddress));
+	accepted = suc_accept4(socket, reinterpret_cast<sockaddr*>(&clientAddress), &addressLength, true);
+	if (accepted != INVALID_SOCKET) {
+		return true;
+	}
+
+	// Another thread may have taken the connection, or the client has given up on it
+	const int error = getLastError();
+	if (wouldBlock(error) || error == ECONNABORTED) {
+		return false;
+	}
+	lastError = error;
+
+	return true;
+}
@@ -0,0 +1,371 @@
+#include "EventLoop.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <sys/eventfd.h>
+
+#include "ClientSocket.h"
+#include "ServerSocket.h"
+#include "Internals.h"
+
+
+
+namespace
+{
+	thread_local suc::EventLoop* currentLoop{ nullptr };
+
+	// epoll_event::data distinguishes registrations by descriptor from waiters,
+	// which are identified by their (aligned) address with the lowest bit set.
+	constexpr std::uint64_t WAITER_TAG = 1;
+
+	inline auto encodeSocket(SOCKET socket) -> std::uint64_t
+	{
+		return static_cast<std::uint64_t>(socket) << 1;
+	}
+
+	inline auto encodeWaiter(suc::EventLoop::Waiter& waiter) -> std::uint64_t
+	{
+		return reinterpret_cast<std::uintptr_t>(&waiter) | WAITER_TAG;
+	}
+
+	auto toEpollEvents(suc::EventLoop::event_flags events) -> uint32_t
+	{
+		uint32_t result = EPOLLRDHUP;
+		if (events & suc::EventLoop::READABLE)		 result |= EPOLLIN;
+		if (events & suc::EventLoop::WRITABLE)		 result |= EPOLLOUT;
+		if (events & suc::EventLoop::EDGE_TRIGGERED) result |= EPOLLET;
+
+		return result;
+	}
+
+	auto fromEpollEvents(uint32_t events) -> suc::EventLoop::event_flags
+	{
+		suc::EventLoop::event_flags result = 0;
+		if (events & EPOLLIN)				  result |= suc::EventLoop::READABLE;
+		if (events & EPOLLOUT)				  result |= suc::EventLoop::WRITABLE;
+		if (events & (EPOLLHUP | EPOLLRDHUP)) result |= suc::EventLoop::HANGUP;
+		if (events & EPOLLERR)				  result |= suc::EventLoop::ERROR;
+
+		return result;
+	}
+} // anonymous namespace
+
+
+
+suc::EventLoop::EventLoop(int maxEventsPerPoll)
+	:
+	readyEvents(static_cast<size_t>(std::max(maxEventsPerPoll, 1)))
+{
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (epollFd == -1)
+		handleLastError();
+
+	wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (wakeupFd == -1)
+	{
+		suc_close(epollFd);
+		handleLastError();
+	}
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.u64 = encodeSocket(wakeupFd);
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &event) == -1)
+	{
+		suc_close(wakeupFd);
+		suc_close(epollFd);
+		handleLastError();
+	}
+
+	if (currentLoop == nullptr) {
+		currentLoop = this;
+	}
+}
+
+
+suc::EventLoop::~EventLoop() noexcept
+{
+	if (currentLoop == this) {
+		currentLoop = nullptr;
+	}
+	suc_close(wakeupFd);
+	suc_close(epollFd);
+}
+
+
+void suc::EventLoop::add(SOCKET socket, event_flags events, Handler handler)
+{
+	if (socket == INVALID_SOCKET) {
+		throw value_error("Cannot register an invalid socket with an event loop.");
+	}
+	if (contains(socket)) {
+		throw value_error("Socket " + std::to_string(socket) + " is already registered.");
+	}
+
+	epoll_event event{};
+	event.events = toEpollEvents(events);
+	event.data.u64 = encodeSocket(socket);
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) == -1)
+		handleLastError();
+
+	registrations.try_emplace(socket, std::make_shared<Registration>(Registration{ std::move(handler), events }));
+}
+
+
+void suc::EventLoop::add(const ClientSocket& socket, event_flags events, Handler handler)
+{
+	add(socket.getNativeHandle(), events, std::move(handler));
+}
+
+
+void suc::EventLoop::add(const ServerSocket& socket, event_flags events, Handler handler)
+{
+	add(socket.getNativeHandle(), events, std::move(handler));
+}
+
+
+void suc::EventLoop::modify(SOCKET socket, event_flags events)
+{
+	auto it = registrations.find(socket);
+	if (it == registrations.end()) {
+		throw value_error("Socket " + std::to_string(socket) + " is not registered.");
+	}
+
+	it->second->events = events;
+	updateInterest(socket, *it->second);
+}
+
+
+void suc::EventLoop::remove(SOCKET socket) noexcept
+{
+	if (registrations.erase(socket) > 0)
+	{
+		// Fails with EBADF if the descriptor has already been closed, in which
+		// case the kernel has removed it from the interest list anyway.
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, socket, nullptr);
+	}
+}
+
+
+void suc::EventLoop::wait(Waiter& waiter)
+{
+	auto it = registrations.find(waiter.socket);
+	if (it != registrations.end())
+	{
+		auto& registration = *it->second;
+		if (registration.waiter != nullptr && registration.waiter != &waiter) {
+			throw value_error("Socket " + std::to_string(waiter.socket) + " already has a waiter.");
+		}
+
+		registration.waiter = &waiter;
+		try {
+			updateInterest(waiter.socket, registration);
+		}
+		catch (const suc_error&) {
+			registration.waiter = nullptr;
+			throw;
+		}
+		return;
+	}
+
+	epoll_event event{};
+	event.events = toEpollEvents(waiter.events) | EPOLLONESHOT;
+	event.data.u64 = encodeWaiter(waiter);
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, waiter.socket, &event) == -1)
+		handleLastError();
+}
+
+
+void suc::EventLoop::post(std::function<void()> task)
+{
+	{
+		std::lock_guard lock(postedMutex);
+		posted.push_back(std::move(task));
+	}
+	eventfd_write(wakeupFd, 1);
+}
+
+
+auto suc::EventLoop::getTimers() noexcept -> TimerWheel&
+{
+	return timers;
+}
+
+
+void suc::EventLoop::cancel(Waiter& waiter) noexcept
+{
+	auto it = registrations.find(waiter.socket);
+	if (it == registrations.end())
+	{
+		// Fails with ENOENT if the waiter is not armed
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, waiter.socket, nullptr);
+		return;
+	}
+
+	auto& registration = *it->second;
+	if (registration.waiter == &waiter)
+	{
+		registration.waiter = nullptr;
+		try {
+			updateInterest(waiter.socket, registration);
+		}
+		catch (const suc_error&) {
+			// The registration itself is still intact
+		}
+	}
+}
+
+
+bool suc::EventLoop::contains(SOCKET socket) const noexcept
+{
+	return registrations.find(socket) != registrations.end();
+}
+
+
+auto suc::EventLoop::size() const noexcept -> size_t
+{
+	return registrations.size();
+}
+
+
+auto suc::EventLoop::poll(int timeout) -> size_t
+{
+	currentLoop = this;
+
+	// Wake up for the next timer
+	const int timerTimeout = timers.getTimeout();
+	if (timerTimeout != TIMEOUT_NEVER && (timeout == TIMEOUT_NEVER || timerTimeout < timeout)) {
+		timeout = timerTimeout;
+	}
+
+	int numEvents = epoll_wait(epollFd, readyEvents.data(), static_cast<int>(readyEvents.size()), timeout);
+	if (numEvents == -1)
+	{
+		if (getLastError() != EINTR) handleLastError();
+		numEvents = 0;
+	}
+
+	size_t dispatched = 0;
+	for (int i = 0; i < numEvents; i++)
+	{
+		const auto& event = readyEvents[static_cast<size_t>(i)];
+		if (event.data.u64 & WAITER_TAG)
+		{
+			auto& waiter = *reinterpret_cast<Waiter*>(event.data.u64 & ~WAITER_TAG);
+			epoll_ctl(epollFd, EPOLL_CTL_DEL, waiter.socket, nullptr);
+			waiter.onReady(waiter, fromEpollEvents(event.events));
+			dispatched++;
+			continue;
+		}
+
+		const auto socket = static_cast<SOCKET>(event.data.u64 >> 1);
+		if (socket == wakeupFd)
+		{
+			eventfd_t value{};
+			eventfd_read(wakeupFd, &value);
+			dispatched += runPosted();
+			continue;
+		}
+
+		// A previous handler may have removed this descriptor. Hold a reference
+		// so that the handler may remove itself while it runs.
+		auto it = registrations.find(socket);
+		if (it == registrations.end()) continue;
+		auto registration = it->second;
+
+		const event_flags events = fromEpollEvents(event.events);
+		const event_flags always = HANGUP | ERROR;
+		if (registration->waiter != nullptr && (events & (registration->waiter->events | always)))
+		{
+			Waiter& waiter = *std::exchange(registration->waiter, nullptr);
+			updateInterest(socket, *registration);
+			waiter.onReady(waiter, events);
+			dispatched++;
+
+			// The waiter may have removed the registration
+			it = registrations.find(socket);
+			if (it == registrations.end() || it->second != registration) continue;
+		}
+
+		if (events & (registration->events | always))
+		{
+			registration->handler(events);
+			dispatched++;
+		}
+	}
+
+	dispatched += timers.advance();
+
+	return dispatched;
+}
+
+
+void suc::EventLoop::updateInterest(SOCKET socket, const Registration& registration)
+{
+	event_flags events = registration.events;
+	if (registration.waiter != nullptr) {
+		events |= registration.waiter->events;
+	}
+
+	epoll_event event{};
+	event.events = toEpollEvents(events);
+	event.data.u64 = encodeSocket(socket);
+	if (epoll_ctl(epollFd, EPOLL_CTL_MOD, socket, &event) == -1)
+		handleLastError();
+}
+
+
+auto suc::EventLoop::runPosted() -> size_t
+{
+	std::vector<std::function<void()>> tasks;
+	{
+		std::lock_guard lock(postedMutex);
+		tasks.swap(posted);
+	}
+
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		try {
+			tasks[i]();
+		}
+		catch (...) {
+			// Run the remaining functions on the next poll()
+			std::lock_guard lock(postedMutex);
+			posted.insert(posted.begin(),
+						  std::make_move_iterator(tasks.begin() + static_cast<ptrdiff_t>(i + 1)),
+						  std::make_move_iterator(tasks.end()));
+			eventfd_write(wakeupFd, 1);
+			throw;
+		}
+	}
+
+	return tasks.size();
+}
+
+
+void suc::EventLoop::run()
+{
+	while (!shouldStop) {
+		poll(TIMEOUT_NEVER);
+	}
+	shouldStop = false;
+}
+
+
+void suc::EventLoop::stop() noexcept
+{
+	shouldStop = true;
+	eventfd_write(wakeupFd, 1);
+}
+
+
+auto suc::EventLoop::getCurrent() -> EventLoop&
+{
+	if (currentLoop == nullptr) {
+		throw runtime_error("The calling thread has no current event loop.");
+	}
+
+	return *currentLoop;
+}
@@ -0,0 +1,266 @@
+#include "Framing.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Internals.h"
+
+
+
+namespace
+{
+	void validateOptions(const suc::FramingOptions& options)
+	{
+		if (options.format == suc::FrameFormat::DELIMITER && options.delimiter.empty()) {
+			throw suc::value_error("The frame delimiter must not be empty.");
+		}
+	}
+
+	[[noreturn]]
+	void throwFrameTooLarge(size_t length, size_t maxFrameSize)
+	{
+		throw suc::value_error("Frame of " + std::to_string(length) + " bytes exceeds the maximum of "
+							   + std::to_string(maxFrameSize) + " bytes.");
+	}
+} // anonymous namespace
+
+
+
+// ------------------------ //
+//		Frame decoder		//
+// ------------------------ //
+
+suc::FrameDecoder::FrameDecoder(FramingOptions options)
+	:
+	options(std::move(options))
+{
+	validateOptions(this->options);
+}
+
+
+void suc::FrameDecoder::feed(ByteBuffer data)
+{
+	buffer.append(std::move(data));
+}
+
+
+void suc::FrameDecoder::feed(std::span<const sbyte> data)
+{
+	buffer.append(data.data(), data.size());
+}
+
+
+auto suc::FrameDecoder::next() -> std::optional<ByteBuffer>
+{
+	if (options.format == FrameFormat::DELIMITER) {
+		return nextDelimited();
+	}
+
+	auto prefix = decodePrefix();
+	if (!prefix) {
+		return std::nullopt;
+	}
+
+	const auto [prefixSize, length] = *prefix;
+	if (length > options.maxFrameSize) {
+		throwFrameTooLarge(length, options.maxFrameSize);
+	}
+	if (buffer.size() - prefixSize < length) {
+		return std::nullopt;
+	}
+
+	ByteBuffer frame = buffer.slice(prefixSize, length);
+	buffer.trimStart(prefixSize + length);
+
+	return frame;
+}
+
+
+auto suc::FrameDecoder::recv(ClientSocket& socket, std::vector<ByteBuffer>& frames, int timeout) -> RecvResult
+{
+	const auto result = socket.recv(buffer, timeout);
+	while (auto frame = next()) {
+		frames.push_back(std::move(*frame));
+	}
+
+	return result;
+}
+
+
+auto suc::FrameDecoder::getBufferedSize() const noexcept -> size_t
+{
+	return buffer.size();
+}
+
+
+auto suc::FrameDecoder::decodePrefix() const -> std::optional<std::pair<size_t, size_t>>
+{
+	if (options.format == FrameFormat::FIXED_LENGTH)
+	{
+		if (buffer.size() < sizeof(uint)) {
+			return std::nullopt;
+		}
+
+		uint length{};
+		buffer.copyTo(0, sizeof(length), &length);
+		return std::pair<size_t, size_t>{ sizeof(length), ntohl(length) };
+	}
+
+	// Every byte carries seven bits of the length, least significant first. The high bit
+	// is set on all bytes but the last.
+	std::array<ubyte, MAX_VARINT_SIZE> bytes{};
+	const size_t available = std::min(buffer.size(), bytes.size());
+	buffer.copyTo(0, available, bytes.data());
+
+	ulong length = 0;
+	for (size_t i = 0; i < available; i++)
+	{
+		// The tenth byte may only contribute the highest bit
+		if (i == MAX_VARINT_SIZE - 1 && bytes[i] > 1) break;
+
+		length |= static_cast<ulong>(bytes[i] & 0x7f) << (7 * i);
+		if ((bytes[i] & 0x80) == 0) {
+			return std::pair<size_t, size_t>{ i + 1, length };
+		}
+	}
+
+	// Incomplete unless it is already longer than any valid prefix
+	if (available < MAX_VARINT_SIZE) {
+		return std::nullopt;
+	}
+	throw value_error("Malformed varint length prefix.");
+}
+
+
+auto suc::FrameDecoder::nextDelimited() -> std::optional<ByteBuffer>
+{
+	const std::string& delimiter = options.delimiter;
+	auto pos = buffer.find(delimiter, scanOffset);
+	if (!pos)
+	{
+		scanOffset = resumeSequenceSearch(buffer.size(), delimiter.size());
+		if (scanOffset > options.maxFrameSize) {
+			throwFrameTooLarge(scanOffset, options.maxFrameSize);
+		}
+		return std::nullopt;
+	}
+
+	if (*pos > options.maxFrameSize) {
+		throwFrameTooLarge(*pos, options.maxFrameSize);
+	}
+
+	ByteBuffer frame = buffer.slice(0, *pos);
+	buffer.trimStart(*pos + delimiter.size());
+	scanOffset = 0;
+
+	return frame;
+}
+
+
+
+// ------------------------ //
+//		Frame encoder		//
+// ------------------------ //
+
+suc::FrameEncoder::FrameEncoder(FramingOptions options)
+	:
+	options(std::move(options))
+{
+	validateOptions(this->options);
+}
+
+
+void suc::FrameEncoder::send(ClientSocket& socket, std::span<const sbyte> payload) const
+{
+	Prefix prefix;
+	const size_t prefixSize = encodePrefix(payload.size(), prefix);
+
+	const iovec prefixBuffer{ prefix.data(), prefixSize };
+	const iovec payloadBuffer{ const_cast<sbyte*>(payload.data()), payload.size() };
+	const iovec delimiterBuffer{ const_cast<char*>(options.delimiter.data()), options.delimiter.size() };
+
+	const auto buffers = options.format == FrameFormat::DELIMITER
+		? std::array<iovec, 2>{ payloadBuffer, delimiterBuffer }
+		: std::array<iovec, 2>{ prefixBuffer, payloadBuffer };
+
+	socket.send(buffers);
+}
+
+
+void suc::FrameEncoder::send(ClientSocket& socket, const ByteBuffer& payload) const
+{
+	Prefix prefix;
+	const size_t prefixSize = encodePrefix(payload.size(), prefix);
+
+	std::vector<iovec> buffers = payload.getSegments();
+	if (options.format == FrameFormat::DELIMITER) {
+		buffers.push_back({ const_cast<char*>(options.delimiter.data()), options.delimiter.size() });
+	}
+	else {
+		buffers.insert(buffers.begin(), { prefix.data(), prefixSize });
+	}
+
+	socket.send(buffers);
+}
+
+
+void suc::FrameEncoder::encode(std::span<const sbyte> payload, ByteBuffer& out) const
+{
+	Prefix prefix;
+	const size_t prefixSize = encodePrefix(payload.size(), prefix);
+
+	out.append(prefix.data(), prefixSize);
+	out.append(payload.data(), payload.size());
+	if (options.format == FrameFormat::DELIMITER) {
+		out.append(options.delimiter.data(), options.delimiter.size());
+	}
+}
+
+
+void suc::FrameEncoder::encode(const ByteBuffer& payload, ByteBuffer& out) const
+{
+	Prefix prefix;
+	const size_t prefixSize = encodePrefix(payload.size(), prefix);
+
+	out.append(prefix.data(), prefixSize);
+	out.append(payload);
+	if (options.format == FrameFormat::DELIMITER) {
+		out.append(options.delimiter.data(), options.delimiter.size());
+	}
+}
+
+
+auto suc::FrameEncoder::encodePrefix(size_t length, Prefix& prefix) const -> size_t
+{
+	if (length > options.maxFrameSize) {
+		throwFrameTooLarge(length, options.maxFrameSize);
+	}
+
+	switch (options.format)
+	{
+	case FrameFormat::FIXED_LENGTH:
+	{
+		if (length > std::numeric_limits<uint>::max()) {
+			throwFrameTooLarge(length, std::numeric_limits<uint>::max());
+		}
+		const uint networkLength = htonl(static_cast<uint>(length));
+		memcpy(prefix.data(), &networkLength, sizeof(networkLength));
+		return sizeof(networkLength);
+	}
+	case FrameFormat::VARINT_LENGTH:
+	{
+		size_t size = 0;
+		while (length >= 0x80)
+		{
+			prefix[size++] = static_cast<ubyte>(length | 0x80);
+			length >>= 7;
+		}
+		prefix[size++] = static_cast<ubyte>(length);
+		return size;
+	}
+	case FrameFormat::DELIMITER:
+		return 0;
+	}
+
+	return 0;
+}
@@ -0,0 +1,290 @@
+#include "HttpParser.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+
+/*
+	All citations of the form
+
+	>>> (rfc-section | [citation-source])
+	citation
+	<<<
+
+	are taken from RFC-7230 (https://tools.ietf.org/html/rfc7230)
+	unless otherwise stated.
+*/
+
+
+
+namespace
+{
+	/*
+	>>> 3.2.6
+	token          = 1*tchar
+	tchar          = "!" / "#" / "$" / "%" / "&" / "'" / "*"
+	               / "+" / "-" / "." / "^" / "_" / "`" / "|" / "~"
+	               / DIGIT / ALPHA
+	<<< */
+	constexpr auto TOKEN_CHARS = [] {
+		std::array<bool, 256> table{};
+		for (int c = '0'; c <= '9'; c++) table[c] = true;
+		for (int c = 'a'; c <= 'z'; c++) table[c] = true;
+		for (int c = 'A'; c <= 'Z'; c++) table[c] = true;
+		for (char c : std::string_view("!#$%&'*+-.^_`|~")) {
+			table[static_cast<unsigned char>(c)] = true;
+		}
+		return table;
+	}();
+
+	bool isToken(std::string_view str)
+	{
+		return !str.empty() && std::all_of(str.begin(), str.end(), [](char c) {
+			return TOKEN_CHARS[static_cast<unsigned char>(c)];
+		});
+	}
+
+	/*
+	Visible characters and obs-text; the request target must not contain whitespace or
+	control characters. */
+	bool isVisible(std::string_view str)
+	{
+		return std::all_of(str.begin(), str.end(), [](char c) {
+			const auto byte = static_cast<unsigned char>(c);
+			return byte > 0x20 && byte != 0x7f;
+		});
+	}
+
+	/*
+	>>> 3.2
+	field-value    = *( field-content / obs-fold )
+	field-content  = field-vchar [ 1*( SP / HTAB ) field-vchar ]
+	field-vchar    = VCHAR / obs-text
+	<<< */
+	bool isFieldValue(std::string_view str)
+	{
+		return std::all_of(str.begin(), str.end(), [](char c) {
+			const auto byte = static_cast<unsigned char>(c);
+			return (byte >= 0x20 && byte != 0x7f) || byte == '\t';
+		});
+	}
+
+	auto trimWhitespace(std::string_view str) -> std::string_view
+	{
+		const size_t first = str.find_first_not_of(" \t");
+		if (first == std::string_view::npos) {
+			return {};
+		}
+		return str.substr(first, str.find_last_not_of(" \t") - first + 1);
+	}
+} // anonymous namespace
+
+
+
+suc::HttpRequestParser::HttpRequestParser(HttpParserOptions options)
+	:
+	options(options)
+{
+}
+
+
+auto suc::HttpRequestParser::parse(std::string_view data) -> HttpParseStatus
+{
+	assert(scanned <= data.size());
+
+	while (state != State::DONE)
+	{
+		const size_t lineEnd = findByte(data, '\n', scanned);
+		if (lineEnd == std::string_view::npos)
+		{
+			scanned = data.size();
+			if (state == State::REQUEST_LINE && scanned > options.maxRequestLineSize) {
+				return fail(HttpParseStatus::REQUEST_LINE_TOO_LONG);
+			}
+			if (state == State::HEADERS && scanned - headersStart > options.maxHeaderSize) {
+				return fail(HttpParseStatus::HEADERS_TOO_LARGE);
+			}
+			return status;
+		}
+
+		/*
+		>>> 3.5
+		Although the line terminator for the start-line and header fields is
+		the sequence CRLF, a recipient MAY recognize a single LF as a line
+		terminator and ignore any preceding CR.
+		<<< */
+		const size_t offset = lineStart;
+		auto line = data.substr(offset, lineEnd - offset);
+		if (!line.empty() && line.back() == '\r') {
+			line.remove_suffix(1);
+		}
+		scanned = lineStart = lineEnd + 1;
+
+		if (state == State::REQUEST_LINE)
+		{
+			if (lineEnd > options.maxRequestLineSize) {
+				return fail(HttpParseStatus::REQUEST_LINE_TOO_LONG);
+			}
+
+			/*
+			>>> 3.5
+			In the interest of robustness, a server that is expecting to receive
+			and parse a request-line SHOULD ignore at least one empty line (CRLF)
+			received prior to the request-line.
+			<<< */
+			if (line.empty()) continue;
+
+			if (!parseRequestLine(line, offset)) {
+				return fail(HttpParseStatus::INVALID);
+			}
+			state = State::HEADERS;
+			headersStart = lineStart;
+		}
+		else
+		{
+			if (lineStart - headersStart > options.maxHeaderSize) {
+				return fail(HttpParseStatus::HEADERS_TOO_LARGE);
+			}
+			if (line.empty())
+			{
+				state = State::DONE;
+				status = HttpParseStatus::COMPLETE;
+				break;
+			}
+
+			if (headers.size() == options.maxHeaderCount) {
+				return fail(HttpParseStatus::HEADERS_TOO_LARGE);
+			}
+			if (!parseHeaderLine(line, offset)) {
+				return fail(HttpParseStatus::INVALID);
+			}
+		}
+	}
+
+	if (status == HttpParseStatus::COMPLETE) {
+		makeHead(data);
+	}
+
+	return status;
+}
+
+
+auto suc::HttpRequestParser::getHead() const noexcept -> const HttpRequestHead&
+{
+	return head;
+}
+
+
+void suc::HttpRequestParser::reset() noexcept
+{
+	state = State::REQUEST_LINE;
+	status = HttpParseStatus::INCOMPLETE;
+	lineStart = scanned = headersStart = 0;
+	headers.clear();
+	head.headers.clear();
+}
+
+
+auto suc::HttpRequestParser::Range::in(std::string_view data) const noexcept -> std::string_view
+{
+	return data.substr(offset, length);
+}
+
+
+bool suc::HttpRequestParser::parseRequestLine(std::string_view line, size_t offset)
+{
+	/*
+	>>> 3.1.1
+	request-line   = method SP request-target SP HTTP-version CRLF
+	<<< */
+	const size_t methodEnd = findByte(line, ' ');
+	if (methodEnd == std::string_view::npos) return false;
+	const size_t targetEnd = findByte(line, ' ', methodEnd + 1);
+	if (targetEnd == std::string_view::npos) return false;
+
+	const auto methodStr = line.substr(0, methodEnd);
+	const auto targetStr = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+	const auto versionStr = line.substr(targetEnd + 1);
+
+	/*
+	>>> 2.6
+	HTTP-version  = HTTP-name "/" DIGIT "." DIGIT
+	HTTP-name     = %x48.54.54.50 ; "HTTP", case-sensitive
+	<<< */
+	const bool isVersion = versionStr.size() == 8 && versionStr.starts_with("HTTP/")
+		&& isdigit(static_cast<unsigned char>(versionStr[5])) && versionStr[6] == '.'
+		&& isdigit(static_cast<unsigned char>(versionStr[7]));
+	if (!isToken(methodStr) || targetStr.empty() || !isVisible(targetStr) || !isVersion) {
+		return false;
+	}
+
+	method = { offset, methodStr.size() };
+	target = { offset + methodEnd + 1, targetStr.size() };
+	version = { offset + targetEnd + 1, versionStr.size() };
+
+	return true;
+}
+
+
+bool suc::HttpRequestParser::parseHeaderLine(std::string_view line, size_t offset)
+{
+	/*
+	>>> 3.2
+	header-field   = field-name ":" OWS field-value OWS
+	<<<
+
+	>>> 3.2.4
+	No whitespace is allowed between the header field-name and colon.  In
+	the past, differences in the handling of such whitespace have led to
+	security vulnerabilities in request routing and response handling.  A
+	server MUST reject any received request message that contains
+	whitespace between a header field-name and colon with a response code
+	of 400 (Bad Request).
+	[...]
+	A server that receives an obs-fold in a request message that is not
+	within a message/http container MUST either reject the message by
+	sending a 400 (Bad Request) [...]
+	<<<
+
+	A token never contains whitespace, which also rejects obs-fold. */
+	const size_t colon = findByte(line, ':');
+	if (colon == std::string_view::npos) return false;
+
+	const auto name = line.substr(0, colon);
+	const auto value = trimWhitespace(line.substr(colon + 1));
+	if (!isToken(name) || !isFieldValue(value)) {
+		return false;
+	}
+
+	const size_t valueOffset = value.empty() ? 0 : static_cast<size_t>(value.data() - line.data());
+	headers.push_back({ { offset, name.size() }, { offset + valueOffset, value.size() } });
+
+	return true;
+}
+
+
+auto suc::HttpRequestParser::fail(HttpParseStatus error) noexcept -> HttpParseStatus
+{
+	state = State::DONE;
+	status = error;
+
+	return status;
+}
+
+
+void suc::HttpRequestParser::makeHead(std::string_view data)
+{
+	head.method = method.in(data);
+	head.target = target.in(data);
+	head.version = version.in(data);
+
+	const size_t queryStart = findByte(head.target, '?');
+	head.path = head.target.substr(0, queryStart);
+	head.query = queryStart == std::string_view::npos ? std::string_view() : head.target.substr(queryStart + 1);
+
+	head.headers.clear();
+	for (const auto& header : headers) {
+		head.headers.add(header.name.in(data), header.value.in(data));
+	}
+	head.size = lineStart;
+}
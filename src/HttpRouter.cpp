@@ -0,0 +1,278 @@
+#include "HttpRouter.h"
+
+#include <algorithm>
+
+
+
+namespace
+{
+	auto getCommonPrefixLength(std::string_view a, std::string_view b) noexcept -> size_t
+	{
+		const auto [end, _] = std::mismatch(a.begin(), a.end(), b.begin(), b.end());
+		return static_cast<size_t>(end - a.begin());
+	}
+
+	[[noreturn]]
+	void throwInvalidPattern(std::string_view pattern, const std::string& reason)
+	{
+		throw suc::value_error("Invalid route \"" + std::string(pattern) + "\": " + reason);
+	}
+} // anonymous namespace
+
+
+
+// ---------------------------- //
+//		Route parameters		//
+// ---------------------------- //
+
+auto suc::RouteParameters::get(std::string_view name) const noexcept -> std::optional<std::string_view>
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (parameters[i].name == name) {
+			return parameters[i].value;
+		}
+	}
+
+	return std::nullopt;
+}
+
+
+auto suc::RouteParameters::size() const noexcept -> size_t
+{
+	return count;
+}
+
+
+
+// ------------------------ //
+//		HTTP router			//
+// ------------------------ //
+
+suc::HttpRouter::HttpRouter()
+	:
+	root(makeNode(""))
+{
+}
+
+
+suc::HttpRouter::~HttpRouter() noexcept = default;
+suc::HttpRouter::HttpRouter(HttpRouter&&) noexcept = default;
+auto suc::HttpRouter::operator=(HttpRouter&&) noexcept -> HttpRouter& = default;
+
+
+void suc::HttpRouter::add(HttpMethod method, std::string_view pattern, Handler handler)
+{
+	if (!pattern.starts_with('/')) {
+		throwInvalidPattern(pattern, "Must start with '/'.");
+	}
+
+	// Walk the pattern in pieces of static text, parameters and the wildcard
+	Node* node = root.get();
+	std::array<std::string_view, RouteParameters::MAX_PARAMETERS> names;
+	size_t parameterCount = 0;
+	for (size_t pos = 0; pos < pattern.size(); )
+	{
+		const char c = pattern[pos];
+		if (c != ':' && c != '*')
+		{
+			const size_t end = std::min(findAnyOf(pattern, ":*", pos), pattern.size());
+			node = &insertStatic(*node, pattern.substr(pos, end - pos));
+			pos = end;
+			continue;
+		}
+
+		if (pattern[pos - 1] != '/') {
+			throwInvalidPattern(pattern, "Parameters and wildcards must span a whole path segment.");
+		}
+		const size_t end = std::min(findByte(pattern, '/', pos), pattern.size());
+		const auto name = pattern.substr(pos + 1, end - pos - 1);
+		if (name.empty() || name.find_first_of(":*") != std::string_view::npos) {
+			throwInvalidPattern(pattern, "Parameters and wildcards need a name.");
+		}
+		if (parameterCount == RouteParameters::MAX_PARAMETERS) {
+			throwInvalidPattern(pattern, "More than " + std::to_string(RouteParameters::MAX_PARAMETERS) + " parameters.");
+		}
+		if (std::find(names.begin(), names.begin() + parameterCount, name) != names.begin() + parameterCount) {
+			throwInvalidPattern(pattern, "The name \"" + std::string(name) + "\" is used more than once.");
+		}
+		names[parameterCount++] = name;
+
+		if (c == ':') {
+			node = &insertNamed(node->parameter, name);
+		}
+		else
+		{
+			if (end != pattern.size()) {
+				throwInvalidPattern(pattern, "The wildcard must be at the end.");
+			}
+			node = &insertNamed(node->wildcard, name);
+		}
+		if (node->prefix != name) {
+			throwInvalidPattern(pattern, "Conflicts with the parameter \"" + node->prefix + "\" of another route.");
+		}
+		pos = end;
+	}
+
+	const auto methodIndex = static_cast<size_t>(method);
+	if (node->handlers[methodIndex] != NO_HANDLER) {
+		throwInvalidPattern(pattern, "Has already been added for this method.");
+	}
+
+	handlers.push_back(std::move(handler));
+	node->handlers[methodIndex] = static_cast<int>(handlers.size() - 1);
+	node->methods |= 1U << methodIndex;
+}
+
+
+auto suc::HttpRouter::match(HttpMethod method, std::string_view path, RouteParameters& parameters) const noexcept
+	-> Match
+{
+	parameters.count = 0;
+
+	const auto methodIndex = static_cast<size_t>(method);
+	if (const Node* node = find(*root, path, 1U << methodIndex, parameters)) {
+		return { &handlers[node->handlers[methodIndex]], node->methods };
+	}
+
+	// Only needed for the 405 response, so it is a separate walk
+	parameters.count = 0;
+	return { nullptr, findMethods(*root, path) };
+}
+
+
+auto suc::HttpRouter::size() const noexcept -> size_t
+{
+	return handlers.size();
+}
+
+
+auto suc::HttpRouter::insertStatic(Node& node, std::string_view text) -> Node&
+{
+	Node* current = &node;
+	while (!text.empty())
+	{
+		const size_t index = current->indices.find(text.front());
+		if (index == std::string::npos)
+		{
+			current->indices.push_back(text.front());
+			current->children.push_back(makeNode(text));
+			return *current->children.back();
+		}
+
+		// Split the child if the text diverges within its prefix
+		auto& child = current->children[index];
+		const size_t common = getCommonPrefixLength(child->prefix, text);
+		if (common < child->prefix.size())
+		{
+			auto parent = makeNode(text.substr(0, common));
+			child->prefix.erase(0, common);
+			parent->indices.push_back(child->prefix.front());
+			parent->children.push_back(std::move(child));
+			child = std::move(parent);
+		}
+
+		current = child.get();
+		text.remove_prefix(common);
+	}
+
+	return *current;
+}
+
+
+auto suc::HttpRouter::insertNamed(std::unique_ptr<Node>& slot, std::string_view name) -> Node&
+{
+	if (slot == nullptr) {
+		slot = makeNode(name);
+	}
+
+	return *slot;
+}
+
+
+auto suc::HttpRouter::makeNode(std::string_view prefix) -> std::unique_ptr<Node>
+{
+	auto node = std::make_unique<Node>();
+	node->prefix = prefix;
+	node->handlers.fill(NO_HANDLER);
+
+	return node;
+}
+
+
+auto suc::HttpRouter::find(const Node& node, std::string_view path, MethodSet methods, RouteParameters& parameters) noexcept
+	-> const Node*
+{
+	if (path.empty() && (node.methods & methods)) {
+		return &node;
+	}
+
+	// Static text first. Only one child can match, because their prefixes start with
+	// different bytes.
+	if (!path.empty())
+	{
+		const size_t index = findByte(node.indices, path.front());
+		if (index != std::string_view::npos)
+		{
+			const Node& child = *node.children[index];
+			if (path.starts_with(child.prefix))
+			{
+				if (const Node* result = find(child, path.substr(child.prefix.size()), methods, parameters)) {
+					return result;
+				}
+			}
+		}
+	}
+
+	// Then a parameter, which takes the segment up to the next slash
+	const size_t count = parameters.count;
+	if (node.parameter != nullptr && !path.empty() && path.front() != '/')
+	{
+		const size_t end = std::min(findByte(path, '/'), path.size());
+		parameters.parameters[count] = { node.parameter->prefix, path.substr(0, end) };
+		parameters.count = count + 1;
+		if (const Node* result = find(*node.parameter, path.substr(end), methods, parameters)) {
+			return result;
+		}
+		parameters.count = count;
+	}
+
+	// The wildcard takes the rest
+	if (node.wildcard != nullptr && (node.wildcard->methods & methods))
+	{
+		parameters.parameters[count] = { node.wildcard->prefix, path };
+		parameters.count = count + 1;
+		return node.wildcard.get();
+	}
+
+	return nullptr;
+}
+
+
+auto suc::HttpRouter::findMethods(const Node& node, std::string_view path) noexcept -> MethodSet
+{
+	// The same walk as find(), but through all routes that match
+	if (path.empty()) {
+		return node.methods | (node.wildcard != nullptr ? node.wildcard->methods : 0);
+	}
+
+	MethodSet methods = 0;
+	const size_t index = findByte(node.indices, path.front());
+	if (index != std::string_view::npos)
+	{
+		const Node& child = *node.children[index];
+		if (path.starts_with(child.prefix)) {
+			methods |= findMethods(child, path.substr(child.prefix.size()));
+		}
+	}
+	if (node.parameter != nullptr && path.front() != '/')
+	{
+		const size_t end = std::min(findByte(path, '/'), path.size());
+		methods |= findMethods(*node.parameter, path.substr(end));
+	}
+	if (node.wildcard != nullptr) {
+		methods |= node.wildcard->methods;
+	}
+
+	return methods;
+}
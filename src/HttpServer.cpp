@@ -1,8 +1,17 @@
 #include "HttpServer.h"
 
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstring>
 #include <iostream>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+
 #include "Async.h"
+#include "ClientSocket.h"
+#include "Internals.h"
 
 /*
 	All citations of the form
@@ -17,248 +26,258 @@
 
 
 
-// ------------------------ //
-//		Http request		//
-// ------------------------ //
-
-suc::HttpRequest::HttpRequest(gsl::not_null<ClientSocket*> sender, RequestLine requestLine, Headers headers)
-	:
-	sender(sender),
-	requestLine(std::move(requestLine)),
-	headers(std::move(headers))
+namespace
 {
-}
+	/*
+	>>> 5.1.1
+	Method = "OPTIONS"			; Section 9.2
+		   | "GET"              ; Section 9.3
+		   | "HEAD"             ; Section 9.4
+		   | "POST"             ; Section 9.5
+		   | "PUT"              ; Section 9.6
+		   | "DELETE"           ; Section 9.7
+		   | "TRACE"            ; Section 9.8
+		   | "CONNECT"			; Section 9.9
+		   | extension-method
+	extension-method = token
+	<<< */
+	constexpr std::pair<suc::HttpMethod, std::string_view> METHOD_NAMES[]{
+		{ suc::HttpMethod::OPTIONS,	"OPTIONS" },
+		{ suc::HttpMethod::GET,		"GET" },
+		{ suc::HttpMethod::HEAD,	"HEAD" },
+		{ suc::HttpMethod::POST,	"POST" },
+		{ suc::HttpMethod::PUT,		"PUT" },
+		{ suc::HttpMethod::DELETE,	"DELETE" },
+		{ suc::HttpMethod::TRACE,	"TRACE" },
+		{ suc::HttpMethod::CONNECT,	"CONNECT" },
+	};
 
+	bool isVersion11(const suc::HttpRequestHead& head) noexcept
+	{
+		return head.version != "HTTP/1.0";
+	}
 
-auto suc::HttpRequest::parseRequest(const ByteBuffer& msg, gsl::not_null<ClientSocket*> client) -> HttpRequest
-{
-	std::string str(static_cast<char*>(msg), msg.size());
-	auto requestFields = splitString(str, CRLF);
 	/*
-	A Http-request MUST have at least a start-line and an empty line:
-	>>> 5
-	Request = Request-Line					; Section 5.1
-              *(( general-header			; Section 4.5
-                  | request-header			; Section 5.3
-                  | entity-header ) CRLF)	; Section 7.1
-              CRLF
-              [ message-body ]				; Section 4.3
+	>>> [RFC-7230 6.1]
+	Connection        = 1#connection-option
+	connection-option = token
+
+	Connection options are case-insensitive.
 	<<< */
-	if (requestFields.size() < 2)
-		throw InvalidHttpRequestException();
+	bool hasConnectionOption(const suc::HttpRequestHead& head, std::string_view option) noexcept
+	{
+		auto value = head.headers.get(suc::HttpHeaderId::CONNECTION).value_or("");
+		while (!value.empty())
+		{
+			const size_t end = std::min(suc::findByte(value, ','), value.size());
+			auto token = value.substr(0, end);
+			value.remove_prefix(std::min(end + 1, value.size()));
+
+			token.remove_prefix(std::min(token.find_first_not_of(" \t"), token.size()));
+			token = token.substr(0, token.find_last_not_of(" \t") + 1);
+			if (suc::equalsIgnoreCase(token, option)) {
+				return true;
+			}
+		}
+
+		return false;
+	}
 
-	auto currentLine = requestFields.begin();
 	/*
-	Discard leading blank lines:
-	>>> 4.1
-	In the interest of robustness, servers SHOULD ignore any empty
-	line(s) received where a Request-Line is expected. In other words, if
-	the server is reading the protocol stream at the beginning of a
-	message and receives a CRLF first, it should ignore the CRLF.
-	<<<
-	
-	Even though:
-	>>> 4.1
-	Certain buggy HTTP/1.0 client implementations generate extra CRLF's
-	after a POST request. To restate what is explicitly forbidden by the
-	BNF, an HTTP/1.1 client MUST NOT preface or follow a request with an
-	extra CRLF.
+	>>> [RFC-7230 6.3]
+	o  If the "close" connection option is present, the connection will
+	   not persist after the current response; else,
+
+	o  If the received protocol is HTTP/1.1 (or later), the connection
+	   will persist after the current response; else,
+
+	o  If the received protocol is HTTP/1.0, the "keep-alive" connection
+	   option is present, [...] the connection will persist after the
+	   current response; otherwise,
+
+	o  The connection will close after the current response.
 	<<< */
-	while (currentLine->empty()) currentLine++;
+	bool isPersistent(const suc::HttpRequestHead& head) noexcept
+	{
+		if (hasConnectionOption(head, "close")) {
+			return false;
+		}
 
-	/*
-	Parse request-line: */
-	auto requestLine = parseRequestLine(*currentLine++);
+		return isVersion11(head) || hasConnectionOption(head, "keep-alive");
+	}
 
 	/*
-	Parse headers: */
-	Headers headers;
-	for (; !currentLine->empty(); currentLine++)
+	>>> [RFC-7230 3.3.2]
+	Content-Length = 1*DIGIT
+	[...]
+	If a message is received that has multiple Content-Length header
+	fields with field-values consisting of the same decimal value, [...]
+	the recipient MUST either reject the message as invalid or replace
+	the duplicated field-values with a single valid Content-Length field
+	containing that decimal value
+	<<<
+
+	Differing values could make the server and a proxy in front of it disagree about
+	where the next request starts.
+
+	@return std::optional<size_t> Zero if the request has no body, nothing if a field is
+	        malformed or the fields differ. */
+	auto getContentLength(const suc::HttpRequestHead& head) noexcept -> std::optional<size_t>
 	{
-		headers.insert(parseHeader(*currentLine));
+		std::optional<size_t> result;
+		for (const auto& field : head.headers)
+		{
+			if (field.id != suc::HttpHeaderId::CONTENT_LENGTH) continue;
+
+			const std::string_view value = field.value;
+			size_t length{};
+			const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), length);
+			if (error != std::errc() || end != value.data() + value.size() || value.empty()) {
+				return std::nullopt;
+			}
+			if (result && *result != length) {
+				return std::nullopt;
+			}
+			result = length;
+		}
+
+		return result.value_or(0);
+	}
+
+	auto makeErrorResponse(suc::HttpStatusCode status) -> suc::HttpResponse
+	{
+		suc::HttpResponse response(status);
+		response.setContent(std::string());
+
+		return response;
 	}
+} // anonymous namespace
+
 
-	return HttpRequest(client, requestLine, headers);
+
+// ------------------------ //
+//		Http request		//
+// ------------------------ //
+
+suc::HttpRequest::HttpRequest(ClientSocket& sender, ByteBuffer message, HttpRequestHead head)
+	:
+	sender(&sender),
+	message(std::move(message)),
+	head(std::move(head)),
+	method(parseMethod(this->head.method)),
+	options(parseOptions(this->head.query))
+{
+}
+
+
+auto suc::HttpRequest::parseRequest(const ByteBuffer& msg, ClientSocket& client) -> HttpRequest
+{
+	// Share the memory; the views of the parsed head stay valid as long as it is held
+	ByteBuffer message = msg;
+	const std::string_view data(message.to<const char*>(), message.size());
+
+	HttpRequestParser parser;
+	switch (parser.parse(data))
+	{
+	case HttpParseStatus::COMPLETE:
+		break;
+	case HttpParseStatus::INCOMPLETE:
+		throw InvalidHttpRequestException("Incomplete request head.");
+	case HttpParseStatus::INVALID:
+		throw InvalidHttpRequestException("Malformed request head.");
+	case HttpParseStatus::REQUEST_LINE_TOO_LONG:
+		throw InvalidHttpRequestException("Request line too long.", HttpStatusCode::REQUEST_URI_TOO_LARGE);
+	case HttpParseStatus::HEADERS_TOO_LARGE:
+		throw InvalidHttpRequestException("Request headers too large.", HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+	}
+
+	return HttpRequest(client, std::move(message), parser.getHead());
 }
 
 auto suc::HttpRequest::getMethod() const noexcept -> Method
 {
-	return requestLine.method;
+	return method;
 }
 
-auto suc::HttpRequest::getPath() const noexcept -> std::string
+auto suc::HttpRequest::getPath() const noexcept -> std::string_view
 {
-	return requestLine.path;
+	return head.path;
 }
 
 bool suc::HttpRequest::hasOption(const std::string& key) const noexcept
 {
-	return requestLine.options.find(key) != requestLine.options.end();
+	return options.find(key) != options.end();
 }
 
 auto suc::HttpRequest::getOption(const std::string& key) const noexcept -> std::optional<std::string>
 {
 	if (hasOption(key))
-		return requestLine.options.at(key);
+		return options.at(key);
 
 	return {};
 }
 
-bool suc::HttpRequest::hasHeader(const std::string& key) const noexcept
+bool suc::HttpRequest::hasHeader(std::string_view key) const noexcept
 {
-	return headers.find(key) != headers.end();
+	return getHeader(key).has_value();
 }
 
-auto suc::HttpRequest::getHeader(const std::string& key) const noexcept -> std::optional<std::string>
+auto suc::HttpRequest::getHeader(std::string_view key) const noexcept -> std::optional<std::string_view>
 {
-	if (hasHeader(key))
-		return headers.at(key);
+	/*
+	>>> 4.2
+	Field names are case-insensitive.
+	<<< */
+	return head.headers.get(key);
+}
 
-	return {};
+
+auto suc::HttpRequest::getBody() const -> ByteBuffer
+{
+	return message.slice(head.size, message.size() - head.size);
 }
 
 void suc::HttpRequest::respond(HttpResponse response)
 {
-	response.sendTo(sender);
+	response.sendTo(*sender);
 }
 
 
-auto suc::HttpRequest::parseRequestLine(const std::string& requestLine) -> RequestLine
+auto suc::HttpRequest::parseOptions(std::string_view query) -> Options
 {
 	/*
-	>>> 5.1
-	Request-Line = Method SP Request-URI SP HTTP-Version CRLF
-	<<< */
-
-	auto assertSize = [](const auto& vec, size_t size, const std::string& msg) {
-		if (vec.size() != size)
-			throw InvalidHttpRequestException(msg);
-	};
-	auto tokens = splitString(requestLine, ' ');
-	assertSize(tokens, 3, "The request line MUST contain exactly 3 fields.");
-
-	const auto& method	= tokens[0];
-	const auto& uri		= tokens[1];
-	const auto& version = tokens[2];
-
-	/*
-	>>> 5.1.2
-	Request-URI = "*" | absoluteURI | abs_path | authority
-	[...]
-	The absoluteURI form is REQUIRED when the request is being made to a
-	proxy.
-	[...]
-	The authority form is only used by the CONNECT method (section 9.9).
-	[...]
-	The Request-URI is transmitted in the format specified in section
-	3.2.1.
-	<<< 
-	
 	>>> 3.2.2
 	http_URL = "http:" "//" host [ ":" port ] [ abs_path [ "?" query ]]
 	<<<
 	*/
-	auto splitPath = splitString(uri, '?');
-	if (splitPath.empty() || splitPath.size() > 2)
-		throw InvalidHttpRequestException("Missing path in request URI.");
-	const auto& path = splitPath[0];
-
-	// Parse options
 	Options options;
-	if (splitPath.size() == 2)
+	while (!query.empty())
 	{
-		for (const auto& opt : splitString(splitPath[1], '&'))
-		{
-			auto splitOpt = splitString(opt, '=');
-			assertSize(splitOpt, 2, "HTTP option must be a key-value pair separated by \"=\"");
+		const size_t end = std::min(findByte(query, '&'), query.size());
+		const auto option = query.substr(0, end);
+		query.remove_prefix(std::min(end + 1, query.size()));
 
-			const auto& key = splitOpt[0];
-			const auto& value = splitOpt[1];
-			options.try_emplace(key, value);
-		}
-	}
-
-	return {
-		parseMethod(method),
-		path,
-		options,
-		version
-	};
-}
+		const size_t separator = findByte(option, '=');
+		if (separator == std::string_view::npos || findByte(option, '=', separator + 1) != std::string_view::npos)
+			throw InvalidHttpRequestException("HTTP option must be a key-value pair separated by \"=\"");
 
-
-auto suc::HttpRequest::parseMethod(const std::string& method) -> Method
-{
-	/*
-	>>> 5.1.1
-	Method = "OPTIONS"			; Section 9.2
-		   | "GET"              ; Section 9.3
-		   | "HEAD"             ; Section 9.4
-		   | "POST"             ; Section 9.5
-		   | "PUT"              ; Section 9.6
-		   | "DELETE"           ; Section 9.7
-		   | "TRACE"            ; Section 9.8
-		   | "CONNECT"			; Section 9.9
-		   | extension-method
-	extension-method = token
-	<<< */
-
-	if (method == "OPTIONS") {
-		return Method::OPTIONS;
-	}
-	if (method == "GET") {
-		return Method::GET;
-	}
-	if (method == "HEAD") {
-		return Method::HEAD;
-	}
-	if (method == "POST") {
-		return Method::POST;
-	}
-	if (method == "PUT") {
-		return Method::PUT;
-	}
-	if (method == "DELETE") {
-		return Method::DELETE;
+		options.try_emplace(std::string(option.substr(0, separator)), std::string(option.substr(separator + 1)));
 	}
-	if (method == "TRACE") {
-		return Method::TRACE;
-	}
-	if (method == "CONNECT") {
-		return Method::CONNECT;
-	}
-	return Method::extension;
+
+	return options;
 }
 
 
-auto suc::HttpRequest::parseHeader(const std::string& headerLine) -> header_type
+auto suc::HttpRequest::parseMethod(std::string_view method) -> Method
 {
-	/*
-	>>> 4.2
-	message-header = field-name ":" [ field-value ]
-    field-name     = token
-    field-value    = *( field-content | LWS )
-    field-content  = <the OCTETs making up the field-value
-                    and consisting of either *TEXT or combinations
-                    of token, separators, and quoted-string>
-	<<< */
-	auto tokens = splitString(headerLine, ':');
-	if (tokens.size() < 2)
-		throw InvalidHttpRequestException("Invalid request header: " + headerLine);
-
-	if (tokens.size() > 2)
+	for (const auto& [value, name] : METHOD_NAMES)
 	{
-		// The value contained one or more colons, re-assemble the value.
-		auto value = tokens[1];
-		for (size_t i = 2; i < tokens.size(); i++)
-			value += ":" + tokens[i];
-		tokens[1] = value;
+		if (method == name) {
+			return value;
+		}
 	}
 
-	const auto& fieldName = tokens[0];
-	const auto& fieldValue = tokens[1];
-
-	return { fieldName, fieldValue };
+	return Method::extension;
 }
 
 
@@ -291,15 +310,16 @@ void suc::HttpResponse::setHeader(const header_type& header) noexcept
 	field and a Content-Length header field, the latter MUST be
 	ignored.
 	<<< */
-	if (header.first == "Content-Length") {
-		if (headers.find("Transfer-Encoding") != headers.end())
+	const HttpHeaderId id = getHttpHeaderId(header.first);
+	if (id == HttpHeaderId::CONTENT_LENGTH) {
+		if (headers.contains(HttpHeaderId::TRANSFER_ENCODING))
 			return;
 	}
-	if (header.first == "Transfer-Encoding") {
-		headers.erase("Content-Length");
+	if (id == HttpHeaderId::TRANSFER_ENCODING) {
+		headers.erase(HttpHeaderId::CONTENT_LENGTH);
 	}
 
-	headers[header.first] = header.second;
+	headers.set(header.first, header.second);
 }
 
 
@@ -312,11 +332,71 @@ void suc::HttpResponse::setContent(std::string body)
 void suc::HttpResponse::setContent(ByteBuffer body)
 {
 	content = std::move(body);
+	fileContent.reset();
 	setHeader({ "Content-Length", std::to_string(content.size()) });
 }
 
 
+void suc::HttpResponse::setContentFile(const std::string& path)
+{
+	const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		throw system_error("Unable to open \"" + path + "\": " + strerror(errno));
+	}
+	auto ownedFd = std::shared_ptr<const int>(new int(fd), [](const int* fd) {
+		close(*fd);
+		delete fd;
+	});
+
+	struct stat fileStat{};
+	if (fstat(fd, &fileStat) == -1) {
+		throw system_error("Unable to stat \"" + path + "\": " + strerror(errno));
+	}
+
+	setContentFile(fd, 0, static_cast<size_t>(fileStat.st_size));
+	fileContent->ownedFd = std::move(ownedFd);
+}
+
+
+void suc::HttpResponse::setContentFile(int fd, ulong offset, size_t length)
+{
+	content = ByteBuffer();
+	fileContent = FileContent{ nullptr, fd, offset, length };
+	setHeader({ "Content-Length", std::to_string(length) });
+}
+
+
 auto suc::HttpResponse::getRaw() const noexcept -> std::string
+{
+	const PooledString head = makeHead();
+	std::string result;
+	result.reserve(head.size() + content.size());
+	result.append(head.data(), head.size());
+	result.append(static_cast<char*>(content), content.size());
+
+	return result;
+}
+
+
+void suc::HttpResponse::sendTo(ClientSocket& client)
+{
+	const PooledString head = makeHead();
+	if (fileContent)
+	{
+		client.send(head.data(), head.size());
+		client.sendFile(fileContent->fd, fileContent->offset, fileContent->length);
+		return;
+	}
+
+	// Send head and body in one call without copying or coalescing the body
+	std::vector<iovec> buffers = content.getSegments();
+	buffers.insert(buffers.begin(), { const_cast<char*>(head.data()), head.size() });
+
+	client.send(buffers);
+}
+
+
+auto suc::HttpResponse::makeHead() const -> PooledString
 {
 	/*
 	>>> 6.0
@@ -327,28 +407,22 @@ auto suc::HttpResponse::getRaw() const noexcept -> std::string
 			   CRLF
 			   [ message-body ]				; Section 7.2
 	<<< */
-	std::string result;
+	PooledString result;
+	result.reserve(BufferPool::SIZE_CLASSES.front() - 1);
 
 	result += makeStatusLine();
 	result += CRLF;
 	for (const auto& header : headers)
 	{
-		result += makeHeaderString(header);
+		appendHeaderString(result, header);
 		result += CRLF;
 	}
 	result += CRLF;
-	result += std::string(static_cast<char*>(content), content.size());
 
 	return result;
 }
 
 
-void suc::HttpResponse::sendTo(gsl::not_null<ClientSocket*> client)
-{
-	client->sendString(getRaw());
-}
-
-
 auto suc::HttpResponse::makeStatusLine() const noexcept -> std::string
 {
 	/*
@@ -367,7 +441,7 @@ auto suc::HttpResponse::makeStatusLine() const noexcept -> std::string
 }
 
 
-auto suc::HttpResponse::makeHeaderString(const header_type& header) noexcept -> std::string
+void suc::HttpResponse::appendHeaderString(PooledString& result, const Headers::Field& header)
 {
 	/*
 	>>> 4.2
@@ -378,13 +452,9 @@ auto suc::HttpResponse::makeHeaderString(const header_type& header) noexcept ->
 					and consisting of either *TEXT or combinations
 					of token, separators, and quoted-string>
 	<<< */
-	std::string result;
-
-	result += header.first;
+	result += header.name;
 	result += ": ";
-	result += header.second;
-
-	return result;
+	result += header.value;
 }
 
 
@@ -393,43 +463,400 @@ auto suc::HttpResponse::makeHeaderString(const header_type& header) noexcept ->
 //		Http server		 //
 // --------------------- //
 
-suc::HttpServer::HttpServer(int port)
+suc::HttpServer::HttpServer(int port, HttpRouter router, HttpServerOptions options)
+	:
+	options(std::move(options)),
+	router(std::move(router)),
+	workers(std::make_unique<WorkerPool>(std::max(this->options.workerCount, 1U))),
+	server(port, IPV4, [this](ClientSocket client) { park(std::move(client), 0); })
 {
-	auto func = std::bind(&HttpServer::handleConnection, this, std::placeholders::_1);
-	server = AsyncServer::create(port, IPV4, func);
+	std::promise<void> started;
+	idleThread = std::thread([this, &started] { runIdleLoop(started); });
+	try {
+		started.get_future().get();
+		server.start();
+	}
+	catch (...) {
+		shutdown();
+		throw;
+	}
 }
 
 
 suc::HttpServer::~HttpServer() noexcept
 {
-	server->terminate();
+	shutdown();
 }
 
 
-void suc::HttpServer::handleConnection(AsyncClient* newClient)
+void suc::HttpServer::shutdown() noexcept
+{
+	shouldStop = true;
+	server.stop(); // Waits for the reactors, which park new connections
+
+	// Nothing is resumed once the idle loop has stopped. Connections that are parked
+	// while the workers finish are discarded with the loop.
+	if (idleLoop != nullptr) {
+		idleLoop->stop();
+	}
+	if (idleThread.joinable()) {
+		idleThread.join();
+	}
+	workers.reset();
+	idleConnections.clear();
+}
+
+
+suc::HttpServer::IdleConnection::IdleConnection(HttpServer& server, ClientSocket client, uint requestCount)
+	:
+	Timer(&HttpServer::onIdleTimeout),
+	server(server),
+	client(std::move(client)),
+	requestCount(requestCount)
 {
-	using namespace std::placeholders;
-	newClient->onMessage = std::bind(&HttpServer::handleClientMessage, this, _1, _2);
-	newClient->onTerminate = std::bind(&HttpServer::handleClientTerminate, this, _1);
-	std::cout << "--- New connection: client #" << newClient->getId() << "\n";
 }
 
 
-void suc::HttpServer::handleClientMessage(const ByteBuffer& msg, gsl::not_null<ClientSocket*> client)
+void suc::HttpServer::handleConnection(ClientSocket client, uint requestCount)
 {
-	auto request = HttpRequest::parseRequest(msg, client);
-	HttpResponse response(
-		HttpStatusCode::OK,
+	ByteBuffer buffer;
+	HttpRequestParser parser(options.parser);
+	size_t requestSize = 0;
+	std::vector<HttpResponse> responses;
+
+	// One deadline per request, set when its first byte has arrived, so that a client
+	// cannot keep a worker by sending a request one byte at a time. Data has arrived
+	// when a connection is resumed.
+	auto deadline = makeDeadline(options.requestTimeout);
+
+	try {
+		bool close = false;
+		bool hasReceived = false; // Data has arrived right behind the previous responses
+		while (!close)
 		{
-			{ "Content-Type", "text/html"}
+			if (!hasReceived && receive(client, buffer, deadline) != RecvStatus::OK)
+			{
+				// Tell the client why a request that it has started is not answered
+				if (buffer.size() > 0 && !shouldStop) {
+					sendResponses(client, { makeErrorResponse(HttpStatusCode::REQUEST_TIMEOUT) });
+				}
+				break;
+			}
+
+			// Answer everything that has arrived before waiting for more
+			const uint previousCount = requestCount;
+			while (!close)
+			{
+				std::optional<HttpRequest> request;
+				try {
+					request = readRequest(buffer, parser, requestSize, client);
+				}
+				catch (const HttpRequest::InvalidHttpRequestException& err) {
+					responses.push_back(makeErrorResponse(err.status));
+					close = true;
+					break;
+				}
+				if (!request) break;
+
+				requestCount++;
+				close = !isPersistent(request->head)
+					|| requestCount == options.maxRequestsPerConnection
+					|| shouldStop;
+
+				try {
+					responses.push_back(handleRequest(*request));
+				}
+				catch (const std::exception&) {
+					responses.push_back(makeErrorResponse(HttpStatusCode::INTERNAL_SERVER_ERROR));
+					close = true;
+				}
+				if (close) {
+					responses.back().setHeader({ "Connection", "close" });
+				}
+				else if (!isVersion11(request->head)) {
+					responses.back().setHeader({ "Connection", "keep-alive" });
+				}
+			}
+
+			sendResponses(client, responses);
+			responses.clear();
+			if (close) break;
+
+			// Clients that send their next request right away are served without the
+			// round trip through the idle loop
+			hasReceived = false;
+			if (buffer.size() == 0)
+			{
+				const auto result = client.recv(buffer, TIMEOUT_INSTANT);
+				if (result.status == RecvStatus::TIMEOUT)
+				{
+					park(std::move(client), requestCount);
+					return;
+				}
+				if (result.status != RecvStatus::OK) break;
+				hasReceived = true;
+			}
+			if (requestCount != previousCount) {
+				deadline = makeDeadline(options.requestTimeout); // The next request has started
+			}
+		}
+	}
+	catch (const suc_error&) {
+		// The client has closed the connection or the socket failed; nothing to answer
+	}
+}
+
+
+auto suc::HttpServer::handleRequest(const HttpRequest& request) -> HttpResponse
+{
+	RouteParameters parameters;
+	const auto match = router.match(request.getMethod(), request.getPath(), parameters);
+	if (match.handler != nullptr) {
+		return (*match.handler)(request, parameters);
+	}
+
+	if (match.allowedMethods == 0) {
+		return makeErrorResponse(HttpStatusCode::NOT_FOUND);
+	}
+
+	/*
+	>>> 10.4.6
+	The response MUST include an Allow header containing a list of valid
+	methods for the requested resource.
+	<<< */
+	std::string allowed;
+	for (const auto& [method, name] : METHOD_NAMES)
+	{
+		if (match.allowedMethods & (1U << static_cast<uint>(method))) {
+			allowed += allowed.empty() ? "" : ", ";
+			allowed += name;
+		}
+	}
+	HttpResponse response = makeErrorResponse(HttpStatusCode::METHOD_NOT_ALLOWED);
+	response.setHeader({ "Allow", allowed });
+
+	return response;
+}
+
+
+auto suc::HttpServer::readRequest(ByteBuffer& buffer, HttpRequestParser& parser, size_t& requestSize,
+                                  ClientSocket& client) -> std::optional<HttpRequest>
+{
+	using Exception = HttpRequest::InvalidHttpRequestException;
+
+	if (buffer.size() == 0) {
+		return std::nullopt;
+	}
+
+	if (requestSize == 0)
+	{
+		// The parser resumes behind the data of the previous call, even if it has moved
+		const std::string_view data(buffer.to<const char*>(), buffer.size());
+		switch (parser.parse(data))
+		{
+		case HttpParseStatus::COMPLETE:
+			break;
+		case HttpParseStatus::INCOMPLETE:
+			return std::nullopt;
+		case HttpParseStatus::INVALID:
+			throw Exception("Malformed request head.");
+		case HttpParseStatus::REQUEST_LINE_TOO_LONG:
+			throw Exception("Request line too long.", HttpStatusCode::REQUEST_URI_TOO_LARGE);
+		case HttpParseStatus::HEADERS_TOO_LARGE:
+			throw Exception("Request headers too large.", HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+		}
+
+		const HttpRequestHead& head = parser.getHead();
+		if (head.headers.contains(HttpHeaderId::TRANSFER_ENCODING)) {
+			throw Exception("Transfer codings are not supported.", HttpStatusCode::NOT_IMPLEMENTED);
+		}
+		const auto contentLength = getContentLength(head);
+		if (!contentLength) {
+			throw Exception("Malformed or conflicting Content-Length.");
+		}
+		if (*contentLength > options.maxBodySize) {
+			throw Exception("Request body too large.", HttpStatusCode::REQUEST_ENTITY_TOO_LARGE);
+		}
+		requestSize = head.size + *contentLength;
+	}
+
+	// Wait for the rest of the body without touching the received bytes
+	if (buffer.size() < requestSize) {
+		return std::nullopt;
+	}
+
+	// The request shares the memory with the buffer; the next request starts behind it.
+	// Only a body that has arrived in several segments is copied, and the parser moves
+	// the views of the head into the request's memory.
+	ByteBuffer message = buffer.slice(0, requestSize);
+	[[maybe_unused]] const auto status = parser.parse({ message.to<const char*>(), requestSize });
+	assert(status == HttpParseStatus::COMPLETE);
+
+	HttpRequest request(client, std::move(message), parser.getHead());
+	buffer.trimStart(requestSize);
+	parser.reset();
+	requestSize = 0;
+
+	return request;
+}
+
+
+auto suc::HttpServer::receive(ClientSocket& client, ByteBuffer& buffer, clock::time_point deadline) -> RecvStatus
+{
+	while (!shouldStop)
+	{
+		const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - clock::now());
+		if (remaining.count() <= 0) {
+			return RecvStatus::TIMEOUT;
 		}
-	);
-	response.setContent("<html><head><title>Yo</title></head><body>Hello World!</body></html>");
-	request.respond(response);
+		const int timeout = static_cast<int>(std::min<long>(remaining.count(), STOP_CHECK_INTERVAL));
+
+		const auto result = client.recv(buffer, timeout);
+		if (result.status != RecvStatus::TIMEOUT) {
+			return result.status;
+		}
+	}
+
+	return RecvStatus::TIMEOUT;
+}
+
+
+void suc::HttpServer::park(ClientSocket client, uint requestCount)
+{
+	if (shouldStop) {
+		return; // Closes the connection
+	}
+
+	auto connection = std::make_shared<IdleConnection>(*this, std::move(client), requestCount);
+	idleLoop->post([this, connection]() { watch(connection); });
 }
 
 
-void suc::HttpServer::handleClientTerminate(AsyncClient* client)
+void suc::HttpServer::runIdleLoop(std::promise<void>& started)
 {
-	std::cout << "--- Disconnect: client #" << client->getId() << "\n";
+	try {
+		idleLoop = std::make_unique<EventLoop>();
+	}
+	catch (...) {
+		started.set_exception(std::current_exception());
+		return;
+	}
+	started.set_value();
+
+	try {
+		idleLoop->run();
+	}
+	catch (const std::exception& err) {
+		std::cerr << "In HttpServer: The idle loop has failed: " << err.what() << '\n';
+	}
+}
+
+
+void suc::HttpServer::watch(std::shared_ptr<IdleConnection> connection)
+{
+	const SOCKET socket = connection->client.getNativeHandle();
+	try {
+		idleLoop->add(socket, EventLoop::READABLE, [this, socket](EventLoop::event_flags events) {
+			resume(socket, events);
+		});
+	}
+	catch (const suc_error&) {
+		return; // Closes the connection
+	}
+
+	if (options.keepAliveTimeout != TIMEOUT_NEVER) {
+		idleLoop->getTimers().schedule(*connection, std::chrono::milliseconds(options.keepAliveTimeout));
+	}
+	idleConnections.try_emplace(socket, std::move(connection));
+}
+
+
+void suc::HttpServer::resume(SOCKET socket, EventLoop::event_flags events)
+{
+	auto it = idleConnections.find(socket);
+	if (it == idleConnections.end()) return;
+
+	const auto connection = std::move(it->second);
+	idleConnections.erase(it);
+	idleLoop->remove(socket);
+	connection->cancel();
+
+	// Connections that have failed or been closed without sending anything are closed
+	if (shouldStop || !(events & EventLoop::READABLE)) return;
+
+	dispatch(connection);
+}
+
+
+void suc::HttpServer::dispatch(std::shared_ptr<IdleConnection> connection)
+{
+	const bool submitted = workers->trySubmit([this, connection]() {
+		handleConnection(std::move(connection->client), connection->requestCount);
+	});
+	if (submitted) return;
+
+	// Waiting for a worker here would stall all other idle connections. The request
+	// stays in the socket until a retry succeeds or the request times out.
+	if (!connection->workerDeadline) {
+		connection->workerDeadline = makeDeadline(options.requestTimeout);
+	}
+	if (clock::now() >= *connection->workerDeadline) {
+		return; // Closes the connection
+	}
+
+	const SOCKET socket = connection->client.getNativeHandle();
+	idleLoop->getTimers().schedule(*connection, std::chrono::milliseconds(WORKER_RETRY_DELAY));
+	idleConnections.try_emplace(socket, std::move(connection));
+}
+
+
+void suc::HttpServer::onIdleTimeout(TimerWheel::Timer& timer)
+{
+	auto& connection = static_cast<IdleConnection&>(timer);
+	HttpServer& server = connection.server;
+	const SOCKET socket = connection.client.getNativeHandle();
+
+	auto it = server.idleConnections.find(socket);
+	if (it == server.idleConnections.end()) return;
+
+	auto retained = std::move(it->second); // Closes the connection unless it is handed on
+	server.idleConnections.erase(it);
+	if (connection.workerDeadline && !server.shouldStop) {
+		server.dispatch(std::move(retained));
+	}
+	else {
+		server.idleLoop->remove(socket);
+	}
+}
+
+
+void suc::HttpServer::sendResponses(ClientSocket& client, const std::vector<HttpResponse>& responses)
+{
+	// Reserved up front, so the strings are not moved after the buffers refer to them
+	std::vector<PooledString> heads;
+	heads.reserve(responses.size());
+	for (const auto& response : responses) {
+		heads.push_back(response.makeHead());
+	}
+
+	std::vector<iovec> buffers;
+	for (size_t i = 0; i < responses.size(); i++)
+	{
+		const HttpResponse& response = responses[i];
+		buffers.push_back({ heads[i].data(), heads[i].size() });
+		if (response.fileContent)
+		{
+			client.send(buffers);
+			buffers.clear();
+			client.sendFile(response.fileContent->fd, response.fileContent->offset, response.fileContent->length);
+			continue;
+		}
+
+		const auto segments = response.content.getSegments();
+		buffers.insert(buffers.end(), segments.begin(), segments.end());
+	}
+
+	if (!buffers.empty()) {
+		client.send(buffers);
+	}
 }
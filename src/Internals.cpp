@@ -1,5 +1,16 @@
 #include "Internals.h"
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef OS_IS_WINDOWS
+	#include <io.h>
+#endif
+#ifdef OS_IS_LINUX
+	#include <sys/sendfile.h>
+#endif
+
 
 
 SOCKET suc_socket(int domain, int type, int protocol)
@@ -33,12 +44,33 @@ SOCKET suc_accept(SOCKET s, sockaddr* addr, int* addrlen)
 #ifdef OS_IS_LINUX
 	// Use socklen_t because Linux is retarded
 	auto _addrlen = static_cast<socklen_t>(*addrlen);
-	return accept(s, addr, &_addrlen);
+	SOCKET result = accept(s, addr, &_addrlen);
+	*addrlen = static_cast<int>(_addrlen);
+	return result;
+#endif
+}
+
+// ACCEPT4
+SOCKET suc_accept4(SOCKET s, sockaddr* addr, int* addrlen, bool nonblocking)
+{
+#ifdef OS_IS_WINDOWS
+	SOCKET result = accept(s, addr, addrlen);
+	if (result != INVALID_SOCKET && nonblocking) {
+		suc_set_nonblocking(result, true);
+	}
+	return result;
+#endif
+#ifdef OS_IS_LINUX
+	// Sets the flags in the same syscall, saving the fcntl round trips
+	auto _addrlen = static_cast<socklen_t>(*addrlen);
+	SOCKET result = accept4(s, addr, &_addrlen, SOCK_CLOEXEC | (nonblocking ? SOCK_NONBLOCK : 0));
+	*addrlen = static_cast<int>(_addrlen);
+	return result;
 #endif
 }
 
 // CONNECT
-int suc_connect(SOCKET s, sockaddr* addr, int addrlen)
+int suc_connect(SOCKET s, const sockaddr* addr, int addrlen)
 {
 #ifdef OS_IS_WINDOWS
 	return connect(s, addr, addrlen);
@@ -71,12 +103,123 @@ int suc_send(SOCKET s, const void* buf, size_t len, int flags)
 #endif
 }
 
+// SENDV
+int suc_sendv(SOCKET s, const iovec* buffers, size_t count, int flags)
+{
+#ifdef OS_IS_WINDOWS
+	WSABUF wsaBuffers[SUC_MAX_IOV];
+	for (size_t i = 0; i < count; i++)
+	{
+		wsaBuffers[i].buf = static_cast<char*>(buffers[i].iov_base);
+		wsaBuffers[i].len = static_cast<ULONG>(buffers[i].iov_len);
+	}
+
+	DWORD sent = 0;
+	if (WSASend(s, wsaBuffers, static_cast<DWORD>(count), &sent, static_cast<DWORD>(flags), nullptr, nullptr) != 0)
+		return SOCKET_ERROR;
+	return static_cast<int>(sent);
+#endif
+#ifdef OS_IS_LINUX
+	msghdr message{};
+	message.msg_iov = const_cast<iovec*>(buffers);
+	message.msg_iovlen = count;
+	return static_cast<int>(sendmsg(s, &message, flags));
+#endif
+}
+
+// SENDFILE
+long suc_sendfile(SOCKET s, int fd, ulong* offset, size_t count)
+{
+#ifdef OS_IS_WINDOWS
+	// No sendfile for C runtime descriptors, copy through a buffer instead
+	char buf[64 * 1024];
+	if (_lseeki64(fd, static_cast<__int64>(*offset), SEEK_SET) == -1)
+		return -1;
+	int read = _read(fd, buf, static_cast<unsigned int>(std::min(count, sizeof(buf))));
+	if (read <= 0)
+		return read;
+
+	int sent = send(s, buf, read, 0);
+	if (sent > 0)
+		*offset += static_cast<ulong>(sent);
+	return sent;
+#endif
+#ifdef OS_IS_LINUX
+	auto _offset = static_cast<off_t>(*offset);
+	ssize_t sent = sendfile(s, fd, &_offset, count);
+	*offset = static_cast<ulong>(_offset);
+	return static_cast<long>(sent);
+#endif
+}
+
 // SELECT
 int suc_select(int nfds, fd_set* readfds, fd_set* writefds, fd_set* exceptfds, timeval* timeout)
 {
 	return select(nfds, readfds, writefds, exceptfds, timeout);
 }
 
+// POLL
+int suc_poll(pollfd* fds, size_t nfds, int timeout)
+{
+#ifdef OS_IS_WINDOWS
+	return WSAPoll(fds, static_cast<ULONG>(nfds), timeout);
+#endif
+#ifdef OS_IS_LINUX
+	return poll(fds, static_cast<nfds_t>(nfds), timeout);
+#endif
+}
+
+// SETSOCKOPT
+int suc_setsockopt(SOCKET s, int level, int optname, const void* optval, int optlen)
+{
+#ifdef OS_IS_WINDOWS
+	return setsockopt(s, level, optname, reinterpret_cast<const char*>(optval), optlen);
+#endif
+#ifdef OS_IS_LINUX
+	return setsockopt(s, level, optname, optval, static_cast<socklen_t>(optlen));
+#endif
+}
+
+// GETSOCKOPT
+int suc_getsockopt(SOCKET s, int level, int optname, void* optval, int* optlen)
+{
+#ifdef OS_IS_WINDOWS
+	return getsockopt(s, level, optname, reinterpret_cast<char*>(optval), optlen);
+#endif
+#ifdef OS_IS_LINUX
+	auto _optlen = static_cast<socklen_t>(*optlen);
+	int result = getsockopt(s, level, optname, optval, &_optlen);
+	*optlen = static_cast<int>(_optlen);
+	return result;
+#endif
+}
+
+// NON-BLOCKING MODE
+int suc_set_nonblocking(SOCKET s, bool nonblocking)
+{
+#ifdef OS_IS_WINDOWS
+	u_long mode = nonblocking ? 1 : 0;
+	return ioctlsocket(s, FIONBIO, &mode);
+#endif
+#ifdef OS_IS_LINUX
+	int flags = fcntl(s, F_GETFL, 0);
+	if (flags == -1) return -1;
+	flags = nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+	return fcntl(s, F_SETFL, flags);
+#endif
+}
+
+// SHUTDOWN
+int suc_shutdown(SOCKET s)
+{
+#ifdef OS_IS_WINDOWS
+	return shutdown(s, SD_BOTH);
+#endif
+#ifdef OS_IS_LINUX
+	return shutdown(s, SHUT_RDWR);
+#endif
+}
+
 // CLOSE
 int suc_close(SOCKET s)
 {
@@ -90,9 +233,9 @@ int suc_close(SOCKET s)
 
 
 
-addrinfo* translateAddress(
+auto translateAddress(
 	const std::string& ip_address, int port,
-	int family, int type, int protocol, int flags)
+	int family, int type, int protocol, int flags) -> suc::AddressList
 {
 	std::string portStr = std::to_string(port);
 	addrinfo hints{};
@@ -105,17 +248,53 @@ addrinfo* translateAddress(
 	hints.ai_flags = flags;
 
 	// Translate address
-	iResult = getaddrinfo(nullptr, portStr.c_str(), &hints, &result);
+	iResult = getaddrinfo(ip_address.c_str(), portStr.c_str(), &hints, &result);
 
 	// iResult == WSATRY_AGAIN
-	for (int attempts = 0; iResult == EAI_AGAIN && attempts < ADDRESS_TRANSLATE_MAX_TRY_AGAIN; attempts++) {
+	auto retryDelay = std::chrono::milliseconds(ADDRESS_TRANSLATE_RETRY_DELAY_MS);
+	for (int attempts = 0; iResult == EAI_AGAIN && attempts < ADDRESS_TRANSLATE_MAX_TRY_AGAIN; attempts++)
+	{
+		std::this_thread::sleep_for(retryDelay);
+		retryDelay *= 2;
 		iResult = getaddrinfo(ip_address.c_str(), portStr.c_str(), &hints, &result);
 	}
 	if (iResult != 0) {
-		handleLastError();
+		throw suc::network_error("Unable to resolve \"" + ip_address + "\": " + gai_strerror(iResult));
 	}
 
-	return result;
+	suc::AddressList addresses;
+	for (addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next)
+	{
+		suc::ResolvedAddress& address = addresses.emplace_back();
+		address.family = ptr->ai_family;
+		address.type = ptr->ai_socktype;
+		address.protocol = ptr->ai_protocol;
+		address.length = static_cast<int>(ptr->ai_addrlen);
+		memcpy(&address.address, ptr->ai_addr, ptr->ai_addrlen);
+	}
+	freeaddrinfo(result);
+
+	if (addresses.empty()) {
+		throw suc::network_error("Unable to resolve \"" + ip_address + "\": No addresses found.");
+	}
+
+	return addresses;
+}
+
+
+auto makeDeadline(int timeout) -> std::chrono::steady_clock::time_point
+{
+	if (timeout == suc::TIMEOUT_NEVER) {
+		return std::chrono::steady_clock::time_point::max();
+	}
+
+	return std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+}
+
+
+auto resumeSequenceSearch(size_t searched, size_t sequenceSize) -> size_t
+{
+	return searched - std::min(searched, sequenceSize - 1);
 }
 
 
@@ -123,13 +302,13 @@ addrinfo* translateAddress(
 [[noreturn]]
 void handleLastError()
 {
-#ifdef OS_IS_WINDOWS
-	auto lastError = WSAGetLastError();
-#endif
-#ifdef OS_IS_LINUX
-	auto lastError = errno;
-#endif
+	handleError(getLastError());
+}
 
+
+[[noreturn]]
+void handleError(int lastError)
+{
 	switch(lastError)
 	{
 	case EACCES:
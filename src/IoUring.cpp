@@ -0,0 +1,282 @@
+#include "IoUring.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "Internals.h"
+
+
+
+namespace
+{
+	std::atomic<suc::IoEngine> selectedEngine{ suc::IoEngine::EPOLL };
+
+	int io_uring_setup(unsigned entries, io_uring_params* params)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+	}
+
+	int io_uring_enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+	}
+
+	// The rings are shared with the kernel, which reads and writes them concurrently.
+	inline auto loadAcquire(const uint* ptr) -> uint
+	{
+		return std::atomic_ref<const uint>(*ptr).load(std::memory_order_acquire);
+	}
+
+	inline void storeRelease(uint* ptr, uint value)
+	{
+		std::atomic_ref<uint>(*ptr).store(value, std::memory_order_release);
+	}
+
+	auto mapRing(int ringFd, size_t size, off_t offset) -> void*
+	{
+		void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, offset);
+		if (ptr == MAP_FAILED) {
+			handleLastError();
+		}
+
+		return ptr;
+	}
+} // anonymous namespace
+
+
+
+auto suc::setIoEngine(IoEngine engine) noexcept -> IoEngine
+{
+	if (engine == IoEngine::IO_URING && !IoUring::isSupported()) {
+		engine = IoEngine::EPOLL;
+	}
+	selectedEngine = engine;
+
+	return engine;
+}
+
+
+auto suc::getIoEngine() noexcept -> IoEngine
+{
+	return selectedEngine;
+}
+
+
+
+// ------------------------ //
+//		IoUring class		//
+// ------------------------ //
+
+bool suc::IoUring::Completion::hasMore() const noexcept
+{
+	return (flags & IORING_CQE_F_MORE) != 0;
+}
+
+
+bool suc::IoUring::isSupported() noexcept
+{
+	// Kernels before 5.19 fail a multishot accept with EINVAL. Accept a connection over
+	// the loopback interface and check that the accept stays armed.
+	static const bool supported = []() {
+		const SOCKET listener = suc_socket(AF_INET, SOCK_STREAM, 0);
+		const SOCKET client = suc_socket(AF_INET, SOCK_STREAM, 0);
+
+		bool result = false;
+		try {
+			sockaddr_in address{};
+			socklen_t addressLength = sizeof(address);
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			if (listener != INVALID_SOCKET && client != INVALID_SOCKET
+				&& suc_bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+				&& suc_listen(listener, 1) == 0
+				&& getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength) == 0
+				&& suc_connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+			{
+				IoUring ring(2); // Cancels the accept when it is destroyed
+				ring.prepareAccept(listener, 0);
+				ring.submit(1);
+				if (auto completion = ring.popCompletion())
+				{
+					result = completion->result >= 0 && completion->hasMore();
+					if (completion->result >= 0) suc_close(completion->result);
+				}
+			}
+		}
+		catch (const suc_error&) {
+			result = false;
+		}
+		if (client != INVALID_SOCKET) suc_close(client);
+		if (listener != INVALID_SOCKET) suc_close(listener);
+
+		return result;
+	}();
+
+	return supported;
+}
+
+
+suc::IoUring::IoUring(uint entries)
+{
+	io_uring_params params{};
+	ringFd = io_uring_setup(entries, &params);
+	if (ringFd == -1)
+		handleLastError();
+
+	try
+	{
+		sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(uint);
+		cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+		{
+			sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+			sqRingPtr = mapRing(ringFd, sqRingBytes, IORING_OFF_SQ_RING);
+			cqRingPtr = sqRingPtr;
+		}
+		else
+		{
+			sqRingPtr = mapRing(ringFd, sqRingBytes, IORING_OFF_SQ_RING);
+			cqRingPtr = mapRing(ringFd, cqRingBytes, IORING_OFF_CQ_RING);
+		}
+
+		sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+		sqes = static_cast<io_uring_sqe*>(mapRing(ringFd, sqesBytes, IORING_OFF_SQES));
+	}
+	catch (const suc_error&)
+	{
+		release();
+		throw;
+	}
+
+	auto* sq = static_cast<char*>(sqRingPtr);
+	sqHead	  = reinterpret_cast<uint*>(sq + params.sq_off.head);
+	sqTail	  = reinterpret_cast<uint*>(sq + params.sq_off.tail);
+	sqArray	  = reinterpret_cast<uint*>(sq + params.sq_off.array);
+	sqMask	  = *reinterpret_cast<uint*>(sq + params.sq_off.ring_mask);
+	sqEntries = params.sq_entries;
+	sqLocalTail = *sqTail;
+
+	auto* cq = static_cast<char*>(cqRingPtr);
+	cqHead = reinterpret_cast<uint*>(cq + params.cq_off.head);
+	cqTail = reinterpret_cast<uint*>(cq + params.cq_off.tail);
+	cqes   = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	cqMask = *reinterpret_cast<uint*>(cq + params.cq_off.ring_mask);
+}
+
+
+suc::IoUring::~IoUring() noexcept
+{
+	release();
+}
+
+
+void suc::IoUring::release() noexcept
+{
+	if (sqes != nullptr) munmap(sqes, sqesBytes);
+	if (cqRingPtr != nullptr && cqRingPtr != sqRingPtr) munmap(cqRingPtr, cqRingBytes);
+	if (sqRingPtr != nullptr) munmap(sqRingPtr, sqRingBytes);
+	if (ringFd != -1) suc_close(ringFd);
+}
+
+
+void suc::IoUring::prepareAccept(SOCKET listener, ulong userData, bool multishot)
+{
+	auto* sqe = nextSqe();
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = listener;
+	sqe->accept_flags = SOCK_CLOEXEC;
+	sqe->user_data = userData;
+	if (multishot) {
+		sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+	}
+}
+
+
+void suc::IoUring::prepareSend(SOCKET socket, const void* buf, size_t size, ulong userData)
+{
+	auto* sqe = nextSqe();
+	sqe->opcode = IORING_OP_SEND;
+	sqe->fd = socket;
+	sqe->addr = reinterpret_cast<std::uintptr_t>(buf);
+	sqe->len = static_cast<std::uint32_t>(size);
+	sqe->msg_flags = MSG_NOSIGNAL;
+	sqe->user_data = userData;
+}
+
+
+void suc::IoUring::prepareRead(int fd, void* buf, size_t size, ulong userData)
+{
+	auto* sqe = nextSqe();
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = fd;
+	sqe->addr = reinterpret_cast<std::uintptr_t>(buf);
+	sqe->len = static_cast<std::uint32_t>(size);
+	sqe->off = static_cast<ulong>(-1); // Use the current file position
+	sqe->user_data = userData;
+}
+
+
+void suc::IoUring::prepareCancel(ulong userData)
+{
+	auto* sqe = nextSqe();
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = userData;
+	sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+}
+
+
+auto suc::IoUring::submit(uint waitFor) -> uint
+{
+	storeRelease(sqTail, sqLocalTail);
+
+	const uint flags = waitFor > 0 ? IORING_ENTER_GETEVENTS : 0;
+	int submitted = 0;
+	do {
+		submitted = io_uring_enter(ringFd, sqPending, waitFor, flags);
+	} while (submitted == -1 && getLastError() == EINTR);
+
+	if (submitted == -1)
+		handleLastError();
+
+	sqPending -= static_cast<uint>(submitted);
+	return static_cast<uint>(submitted);
+}
+
+
+auto suc::IoUring::popCompletion() noexcept -> std::optional<Completion>
+{
+	const uint head = *cqHead;
+	if (head == loadAcquire(cqTail)) {
+		return {};
+	}
+
+	const auto& cqe = cqes[head & cqMask];
+	Completion result{ cqe.user_data, cqe.res, cqe.flags };
+	storeRelease(cqHead, head + 1);
+
+	return result;
+}
+
+
+auto suc::IoUring::nextSqe() -> io_uring_sqe*
+{
+	// Flush the queue if it is full. Without SQPOLL the kernel consumes all
+	// entries during io_uring_enter, so this always makes room.
+	if (sqLocalTail - loadAcquire(sqHead) >= sqEntries) {
+		submit();
+	}
+
+	const uint index = sqLocalTail & sqMask;
+	auto* sqe = &sqes[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	sqArray[index] = index;
+
+	sqLocalTail++;
+	sqPending++;
+
+	return sqe;
+}
@@ -0,0 +1,191 @@
+#include "OutboundQueue.h"
+
+#include <algorithm>
+#include <array>
+
+#include "ClientSocket.h"
+#include "Internals.h"
+
+
+
+suc::OutboundQueue::OutboundQueue(
+	ClientSocket& socket,
+	EventLoop& loop,
+	size_t lowWatermark,
+	size_t highWatermark)
+	:
+	loop(loop),
+	lowWatermark(std::min(lowWatermark, highWatermark)),
+	highWatermark(highWatermark)
+{
+	this->socket = socket.getNativeHandle();
+	events = EventLoop::WRITABLE;
+	onReady = [](Waiter& waiter, EventLoop::event_flags) {
+		auto& self = static_cast<OutboundQueue&>(waiter);
+		self.isArmed = false;
+		self.handleWritable();
+	};
+}
+
+
+suc::OutboundQueue::~OutboundQueue() noexcept
+{
+	if (isArmed) {
+		loop.cancel(*this);
+	}
+}
+
+
+bool suc::OutboundQueue::write(std::span<const sbyte> data)
+{
+	// Send directly without copying if nothing is queued
+	if (chunks.empty())
+	{
+		while (!data.empty())
+		{
+			int written = suc_send(socket, data.data(), data.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (written == -1)
+			{
+				const int error = getLastError();
+				if (error == EINTR) continue;
+				if (error == EAGAIN || error == EWOULDBLOCK) break;
+				handleError(error);
+			}
+			data = data.subspan(static_cast<size_t>(written));
+		}
+		if (data.empty()) {
+			return true;
+		}
+	}
+
+	if (data.empty()) {
+		return !isPaused;
+	}
+
+	// Coalesce small writes into the last chunk
+	if (!chunks.empty() && chunks.back().size() + data.size() <= CHUNK_SIZE) {
+		chunks.back().insert(chunks.back().end(), data.begin(), data.end());
+	}
+	else {
+		chunks.emplace_back(data.begin(), data.end());
+	}
+	queuedBytes += data.size();
+
+	if (!isArmed)
+	{
+		loop.wait(*this);
+		isArmed = true;
+	}
+
+	if (queuedBytes > highWatermark) {
+		isPaused = true;
+	}
+
+	return !isPaused;
+}
+
+
+bool suc::OutboundQueue::write(const std::string& str)
+{
+	return write(std::span<const sbyte>(str.data(), str.size()));
+}
+
+
+void suc::OutboundQueue::onWritable(std::function<void()> f)
+{
+	onWritableFunc = std::move(f);
+}
+
+
+void suc::OutboundQueue::onDrain(std::function<void()> f)
+{
+	onDrainFunc = std::move(f);
+}
+
+
+void suc::OutboundQueue::onError(std::function<void(const suc_error&)> f)
+{
+	onErrorFunc = std::move(f);
+}
+
+
+auto suc::OutboundQueue::size() const noexcept -> size_t
+{
+	return queuedBytes;
+}
+
+
+bool suc::OutboundQueue::empty() const noexcept
+{
+	return queuedBytes == 0;
+}
+
+
+void suc::OutboundQueue::flush()
+{
+	while (!chunks.empty())
+	{
+		std::array<iovec, SUC_MAX_IOV> buffers;
+		size_t count = 0;
+		for (auto it = chunks.begin(); it != chunks.end() && count < buffers.size(); it++, count++)
+		{
+			const size_t skip = count == 0 ? offset : 0;
+			buffers[count] = { it->data() + skip, it->size() - skip };
+		}
+
+		int written = suc_sendv(socket, buffers.data(), count, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (written == -1)
+		{
+			const int error = getLastError();
+			if (error == EINTR) continue;
+			if (error == EAGAIN || error == EWOULDBLOCK) return;
+			handleError(error);
+		}
+
+		// Drop the chunks that have been sent completely
+		auto remaining = static_cast<size_t>(written);
+		queuedBytes -= remaining;
+		while (remaining > 0 && remaining >= chunks.front().size() - offset)
+		{
+			remaining -= chunks.front().size() - offset;
+			chunks.pop_front();
+			offset = 0;
+		}
+		offset += remaining;
+	}
+}
+
+
+void suc::OutboundQueue::handleWritable()
+{
+	try {
+		flush();
+	}
+	catch (const suc_error& err)
+	{
+		chunks.clear();
+		offset = 0;
+		queuedBytes = 0;
+		isPaused = false;
+		if (!onErrorFunc) throw;
+		onErrorFunc(err);
+		return;
+	}
+
+	if (!chunks.empty())
+	{
+		loop.wait(*this);
+		isArmed = true;
+	}
+
+	if (isPaused && queuedBytes < lowWatermark)
+	{
+		isPaused = false;
+		if (onWritableFunc) onWritableFunc();
+	}
+
+	// onWritable may have queued more data
+	if (chunks.empty() && onDrainFunc) {
+		onDrainFunc();
+	}
+}
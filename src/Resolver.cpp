@@ -0,0 +1,192 @@
+#include "Resolver.h"
+
+#include "Internals.h"
+
+
+
+auto suc::Resolver::KeyHash::operator()(const Key& key) const noexcept -> size_t
+{
+	size_t hash = std::hash<std::string>{}(key.host);
+	hash ^= std::hash<int>{}(key.port) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<int>{}(key.family) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+	return hash;
+}
+
+
+auto suc::Resolver::getDefault() -> Resolver&
+{
+	static Resolver resolver;
+	return resolver;
+}
+
+
+suc::Resolver::Resolver(std::chrono::seconds ttl, std::chrono::seconds negativeTtl, size_t maxEntries)
+	:
+	ttl(ttl),
+	negativeTtl(negativeTtl),
+	maxEntries(maxEntries)
+{
+}
+
+
+suc::Resolver::~Resolver() noexcept
+{
+	{
+		std::lock_guard lock(jobMutex);
+		shouldStop = true;
+	}
+	jobAvailable.notify_all();
+
+	if (resolverThread.joinable()) {
+		resolverThread.join();
+	}
+
+	while (!jobs.empty())
+	{
+		jobs.front().promise.set_exception(
+			std::make_exception_ptr(network_error("The resolver has been destroyed."))
+		);
+		jobs.pop();
+	}
+}
+
+
+auto suc::Resolver::resolve(const std::string& host, int port, int family) -> AddressListPtr
+{
+	std::optional<Job> job;
+	auto result = lookup({ host, port, family }, job);
+	if (job) {
+		complete(*job);
+	}
+
+	return result.get();
+}
+
+
+auto suc::Resolver::resolveAsync(const std::string& host, int port, int family)
+	-> std::shared_future<AddressListPtr>
+{
+	std::optional<Job> job;
+	auto result = lookup({ host, port, family }, job);
+	if (job)
+	{
+		{
+			std::lock_guard lock(jobMutex);
+			if (!resolverThread.joinable()) {
+				resolverThread = std::thread(&Resolver::runResolverThread, this);
+			}
+			jobs.push(std::move(*job));
+		}
+		jobAvailable.notify_one();
+	}
+
+	return result;
+}
+
+
+void suc::Resolver::clear()
+{
+	std::lock_guard lock(cacheMutex);
+	std::erase_if(cache, [](const auto& item) {
+		return item.second.expires != clock::time_point::max();
+	});
+}
+
+
+auto suc::Resolver::getStats() const -> Stats
+{
+	std::lock_guard lock(cacheMutex);
+	return { hits, negativeHits, misses, cache.size() };
+}
+
+
+auto suc::Resolver::lookup(const Key& key, std::optional<Job>& newJob) -> std::shared_future<AddressListPtr>
+{
+	const auto now = clock::now();
+	std::lock_guard lock(cacheMutex);
+
+	auto it = cache.find(key);
+	if (it != cache.end() && it->second.expires > now)
+	{
+		// Also counts requests that wait for a pending resolution
+		if (it->second.failed) negativeHits++;
+		else hits++;
+
+		return it->second.result;
+	}
+
+	misses++;
+	if (it == cache.end() && cache.size() >= maxEntries) {
+		evict(now);
+	}
+
+	newJob.emplace();
+	newJob->key = key;
+	newJob->entryId = nextEntryId++;
+
+	auto& entry = cache[key];
+	entry = Entry{ newJob->promise.get_future().share() };
+	entry.id = newJob->entryId;
+
+	return entry.result;
+}
+
+
+void suc::Resolver::complete(Job& job)
+{
+	bool failed = false;
+	try {
+		auto addresses = translateAddress(job.key.host, job.key.port, job.key.family, SOCK_STREAM, IPPROTO_TCP, 0);
+		job.promise.set_value(std::make_shared<const AddressList>(std::move(addresses)));
+	}
+	catch (...) {
+		// Every waiter must be woken up, whatever has failed
+		job.promise.set_exception(std::current_exception());
+		failed = true;
+	}
+
+	std::lock_guard lock(cacheMutex);
+	auto it = cache.find(job.key);
+	if (it != cache.end() && it->second.id == job.entryId)
+	{
+		it->second.failed = failed;
+		it->second.expires = clock::now() + (failed ? negativeTtl : ttl);
+	}
+}
+
+
+void suc::Resolver::evict(clock::time_point now)
+{
+	std::erase_if(cache, [now](const auto& item) {
+		return item.second.expires <= now;
+	});
+
+	// Still full: drop arbitrary resolved entries
+	for (auto it = cache.begin(); cache.size() >= maxEntries && it != cache.end(); )
+	{
+		if (it->second.expires != clock::time_point::max()) {
+			it = cache.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+}
+
+
+void suc::Resolver::runResolverThread()
+{
+	while (true)
+	{
+		std::unique_lock lock(jobMutex);
+		jobAvailable.wait(lock, [this]() { return shouldStop || !jobs.empty(); });
+		if (shouldStop) return;
+
+		Job job = std::move(jobs.front());
+		jobs.pop();
+		lock.unlock();
+
+		complete(job);
+	}
+}
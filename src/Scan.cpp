@@ -0,0 +1,373 @@
+#include "Scan.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+#include "SocketUtility.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define SUC_SCAN_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
+
+// GCC and Clang only emit vector instructions in functions that are compiled for them,
+// which allows one binary to contain all kernels. MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+	#define SUC_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define SUC_TARGET(isa)
+#endif
+
+
+
+namespace
+{
+	constexpr size_t npos = std::string_view::npos;
+
+	// The SSE4.2 string instructions compare against at most 16 bytes
+	constexpr size_t MAX_SET_SIZE = 16;
+
+	struct Kernel
+	{
+		suc::ScanKernel type;
+		auto (*findAnyOf)(std::string_view data, std::string_view set, size_t from) noexcept -> size_t;
+		auto (*findSequence)(std::string_view data, std::string_view sequence, size_t from) noexcept -> size_t;
+	};
+
+
+
+	// ------------------------ //
+	//		Scalar kernel		//
+	// ------------------------ //
+
+	auto findAnyOfScalar(std::string_view data, std::string_view set, size_t from) noexcept -> size_t
+	{
+		if (set.size() == 1)
+		{
+			const void* pos = memchr(data.data() + from, set.front(), data.size() - from);
+			return pos == nullptr ? npos : static_cast<const char*>(pos) - data.data();
+		}
+
+		std::array<bool, 256> isMember{};
+		for (char c : set) {
+			isMember[static_cast<unsigned char>(c)] = true;
+		}
+		for (size_t i = from; i < data.size(); i++)
+		{
+			if (isMember[static_cast<unsigned char>(data[i])]) {
+				return i;
+			}
+		}
+
+		return npos;
+	}
+
+	auto findSequenceScalar(std::string_view data, std::string_view sequence, size_t from) noexcept -> size_t
+	{
+		return data.find(sequence, from);
+	}
+
+	constexpr Kernel SCALAR_KERNEL{ suc::ScanKernel::SCALAR, findAnyOfScalar, findSequenceScalar };
+
+
+
+#ifdef SUC_SCAN_X86
+	// ------------------------ //
+	//		SSE4.2 kernel		//
+	// ------------------------ //
+
+	constexpr int ANY_OF_MODE = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT;
+
+	SUC_TARGET("sse4.2")
+	auto findAnyOfSse42(std::string_view data, std::string_view set, size_t from) noexcept -> size_t
+	{
+		if (set.size() > MAX_SET_SIZE) {
+			return findAnyOfScalar(data, set, from);
+		}
+
+		std::array<char, 16> setBytes{};
+		memcpy(setBytes.data(), set.data(), set.size());
+		const __m128i needles = _mm_loadu_si128(reinterpret_cast<const __m128i*>(setBytes.data()));
+		const int setSize = static_cast<int>(set.size());
+
+		size_t i = from;
+		for (; i + 16 <= data.size(); i += 16)
+		{
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+			const int index = _mm_cmpestri(needles, setSize, block, 16, ANY_OF_MODE);
+			if (index < 16) {
+				return i + index;
+			}
+		}
+		if (i == data.size()) {
+			return npos;
+		}
+		if (data.size() < 16) {
+			return findAnyOfScalar(data, set, i);
+		}
+
+		// Scan the last 16 bytes again and ignore matches in front of i
+		const size_t last = data.size() - 16;
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + last));
+		const __m128i matches = _mm_cmpestrm(needles, setSize, block, 16, ANY_OF_MODE | _SIDD_BIT_MASK);
+		const auto mask = static_cast<uint32_t>(_mm_cvtsi128_si32(matches)) >> (i - last);
+
+		return mask == 0 ? npos : i + std::countr_zero(mask);
+	}
+
+	/*
+	Compares the first and the last byte of the sequence at 16 positions at once and only
+	checks the bytes in between for positions where both match. This is faster than the
+	ordered-comparison mode of pcmpestri, which finds only one candidate per step. */
+	SUC_TARGET("sse4.2")
+	auto findSequenceSse42(std::string_view data, std::string_view sequence, size_t from) noexcept -> size_t
+	{
+		if (sequence.size() < 2) {
+			return sequence.empty() ? data.find(sequence, from) : findAnyOfSse42(data, sequence, from);
+		}
+
+		const size_t lastOffset = sequence.size() - 1;
+		const __m128i first = _mm_set1_epi8(sequence.front());
+		const __m128i last = _mm_set1_epi8(sequence.back());
+
+		size_t i = from;
+		for (; i + lastOffset + 16 <= data.size(); i += 16)
+		{
+			const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+			const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i + lastOffset));
+			const __m128i candidates = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last));
+			for (auto mask = static_cast<uint32_t>(_mm_movemask_epi8(candidates)); mask != 0; mask &= mask - 1)
+			{
+				const size_t pos = i + std::countr_zero(mask);
+				if (sequence.size() == 2 || memcmp(data.data() + pos + 1, sequence.data() + 1, sequence.size() - 2) == 0) {
+					return pos;
+				}
+			}
+		}
+
+		return findSequenceScalar(data, sequence, i);
+	}
+
+	constexpr Kernel SSE42_KERNEL{ suc::ScanKernel::SSE42, findAnyOfSse42, findSequenceSse42 };
+
+
+
+	// -------------------- //
+	//		AVX2 kernel		//
+	// -------------------- //
+
+	SUC_TARGET("avx2")
+	inline auto matchAnyAvx2(const char* data, const __m256i* needles, size_t count) noexcept -> uint32_t
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+		__m256i matches = _mm256_cmpeq_epi8(block, needles[0]);
+		for (size_t k = 1; k < count; k++) {
+			matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, needles[k]));
+		}
+
+		return static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+	}
+
+	/*
+	Compares each block once per byte of the set. The delimiter sets of HTTP have one to
+	three bytes, for which this beats the fixed latency of pcmpestri. */
+	SUC_TARGET("avx2")
+	auto findAnyOfAvx2(std::string_view data, std::string_view set, size_t from) noexcept -> size_t
+	{
+		if (set.size() > MAX_SET_SIZE) {
+			return findAnyOfScalar(data, set, from);
+		}
+
+		__m256i needles[MAX_SET_SIZE];
+		for (size_t k = 0; k < set.size(); k++) {
+			needles[k] = _mm256_set1_epi8(set[k]);
+		}
+
+		size_t i = from;
+		for (; i + 32 <= data.size(); i += 32)
+		{
+			const uint32_t mask = matchAnyAvx2(data.data() + i, needles, set.size());
+			if (mask != 0) {
+				return i + std::countr_zero(mask);
+			}
+		}
+		if (i == data.size()) {
+			return npos;
+		}
+		if (data.size() < 32) {
+			return findAnyOfSse42(data, set, i);
+		}
+
+		// Scan the last 32 bytes again and ignore matches in front of i
+		const size_t last = data.size() - 32;
+		const uint32_t mask = matchAnyAvx2(data.data() + last, needles, set.size()) >> (i - last);
+
+		return mask == 0 ? npos : i + std::countr_zero(mask);
+	}
+
+	SUC_TARGET("avx2")
+	auto findSequenceAvx2(std::string_view data, std::string_view sequence, size_t from) noexcept -> size_t
+	{
+		if (sequence.size() < 2) {
+			return sequence.empty() ? data.find(sequence, from) : findAnyOfAvx2(data, sequence, from);
+		}
+
+		const size_t lastOffset = sequence.size() - 1;
+		const __m256i first = _mm256_set1_epi8(sequence.front());
+		const __m256i last = _mm256_set1_epi8(sequence.back());
+
+		size_t i = from;
+		for (; i + lastOffset + 32 <= data.size(); i += 32)
+		{
+			const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data() + i));
+			const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data() + i + lastOffset));
+			const __m256i candidates = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first),
+														_mm256_cmpeq_epi8(blockLast, last));
+			for (auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(candidates)); mask != 0; mask &= mask - 1)
+			{
+				const size_t pos = i + std::countr_zero(mask);
+				if (sequence.size() == 2 || memcmp(data.data() + pos + 1, sequence.data() + 1, sequence.size() - 2) == 0) {
+					return pos;
+				}
+			}
+		}
+
+		return findSequenceSse42(data, sequence, i);
+	}
+
+	constexpr Kernel AVX2_KERNEL{ suc::ScanKernel::AVX2, findAnyOfAvx2, findSequenceAvx2 };
+#endif // SUC_SCAN_X86
+
+
+
+	// -------------------- //
+	//		Dispatching		//
+	// -------------------- //
+
+	bool cpuSupports(suc::ScanKernel kernel) noexcept
+	{
+#if defined(SUC_SCAN_X86) && defined(_MSC_VER)
+		std::array<int, 4> info{};
+		__cpuid(info.data(), 1);
+		const bool sse42 = (info[2] & (1 << 20)) != 0;
+		const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0
+								&& (_xgetbv(0) & 0x6) == 0x6;
+		__cpuidex(info.data(), 7, 0);
+		const bool avx2 = osSavesYmm && (info[1] & (1 << 5)) != 0;
+#elif defined(SUC_SCAN_X86)
+		__builtin_cpu_init();
+		const bool sse42 = __builtin_cpu_supports("sse4.2");
+		const bool avx2 = __builtin_cpu_supports("avx2");
+#else
+		const bool sse42 = false;
+		const bool avx2 = false;
+#endif
+
+		switch (kernel)
+		{
+		case suc::ScanKernel::SCALAR: return true;
+		case suc::ScanKernel::SSE42: return sse42;
+		case suc::ScanKernel::AVX2: return avx2 && sse42;
+		}
+
+		return false;
+	}
+
+	auto getKernel(suc::ScanKernel kernel) noexcept -> const Kernel*
+	{
+#ifdef SUC_SCAN_X86
+		switch (kernel)
+		{
+		case suc::ScanKernel::SCALAR: return &SCALAR_KERNEL;
+		case suc::ScanKernel::SSE42: return &SSE42_KERNEL;
+		case suc::ScanKernel::AVX2: return &AVX2_KERNEL;
+		}
+#endif
+
+		return &SCALAR_KERNEL;
+	}
+
+	// Selected on first use, which may happen during static initialization of another file
+	std::atomic<const Kernel*> activeKernel{ nullptr };
+
+	auto getActiveKernel() noexcept -> const Kernel&
+	{
+		const Kernel* kernel = activeKernel.load(std::memory_order_relaxed);
+		if (kernel == nullptr)
+		{
+			kernel = &SCALAR_KERNEL;
+			for (auto type : { suc::ScanKernel::AVX2, suc::ScanKernel::SSE42 })
+			{
+				if (cpuSupports(type))
+				{
+					kernel = getKernel(type);
+					break;
+				}
+			}
+			activeKernel.store(kernel, std::memory_order_relaxed);
+		}
+
+		return *kernel;
+	}
+} // anonymous namespace
+
+
+
+auto suc::findByte(std::string_view data, char c, size_t from) noexcept -> size_t
+{
+	if (from >= data.size()) {
+		return npos;
+	}
+
+	// The C library selects a vectorized memchr for the CPU itself, which is at least as
+	// fast as the kernels here
+	const void* pos = memchr(data.data() + from, c, data.size() - from);
+	return pos == nullptr ? npos : static_cast<const char*>(pos) - data.data();
+}
+
+
+auto suc::findAnyOf(std::string_view data, std::string_view set, size_t from) noexcept -> size_t
+{
+	if (from >= data.size() || set.empty()) {
+		return npos;
+	}
+
+	return getActiveKernel().findAnyOf(data, set, from);
+}
+
+
+auto suc::findSequence(std::string_view data, std::string_view sequence, size_t from) noexcept -> size_t
+{
+	if (from > data.size() || sequence.size() > data.size() - from) {
+		return npos;
+	}
+
+	return getActiveKernel().findSequence(data, sequence, from);
+}
+
+
+auto suc::getScanKernel() noexcept -> ScanKernel
+{
+	return getActiveKernel().type;
+}
+
+
+bool suc::isScanKernelSupported(ScanKernel kernel) noexcept
+{
+	return cpuSupports(kernel);
+}
+
+
+void suc::setScanKernel(ScanKernel kernel)
+{
+	if (!cpuSupports(kernel)) {
+		throw value_error("The CPU does not support the requested scan kernel.");
+	}
+
+	activeKernel.store(getKernel(kernel), std::memory_order_relaxed);
+}
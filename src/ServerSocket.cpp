@@ -9,9 +9,9 @@
 
 
 
-suc::ServerSocket::ServerSocket(int port, int family)
+suc::ServerSocket::ServerSocket(int port, int family, ServerSocketOptions options)
 {
-	bind(port, family);
+	bind(port, family, options);
 }
 
 
@@ -46,7 +46,7 @@ suc::ServerSocket& suc::ServerSocket::operator=(ServerSocket&& rhs) noexcept
 }
 
 
-void suc::ServerSocket::bind(int port, int family)
+void suc::ServerSocket::bind(int port, int family, ServerSocketOptions options)
 {
 	if (!(family == IPV4 || family == IPV6)) {
 		throw value_error("Invalid family: " + std::to_string(family));
@@ -57,6 +57,13 @@ void suc::ServerSocket::bind(int port, int family)
 	if (socket == -1)
 		handleLastError();
 
+	if (options.reusePort)
+	{
+		int enable = 1;
+		if (suc_setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == -1)
+			handleLastError();
+	}
+
 	// Bind to localhost
 	memset(&address, 0, sizeof(address));
 	address.sin_family = family;
@@ -68,8 +75,12 @@ void suc::ServerSocket::bind(int port, int family)
 		handleLastError();
 
 	// Listen
-	const int backlogQueueSize = 5; // Maximum on most systems
-	suc_listen(socket, backlogQueueSize); // Cannot fail if the first argument is a valid socket descriptor
+	if (suc_listen(socket, options.backlog) == -1)
+		handleLastError();
+
+	// Required by acceptAll() to drain the backlog without blocking
+	if (suc_set_nonblocking(socket, true) == -1)
+		handleLastError();
 
 	_isClosed = false;
 }
@@ -77,19 +88,78 @@ void suc::ServerSocket::bind(int port, int family)
 
 auto suc::ServerSocket::accept() const -> ClientSocket
 {
-	sockaddr_in clientAddress{};
-	int addressLength = static_cast<int>(sizeof(clientAddress));
-	SOCKET newSock = suc_accept(
-		socket,
-		reinterpret_cast<sockaddr*>(&clientAddress),
-		&addressLength
-	);
-
-	if (newSock == -1)
-		handleLastError();
+	while (true)
+	{
+		sockaddr_storage clientAddress{};
+		int addressLength = static_cast<int>(sizeof(clientAddress));
+		SOCKET newSock = suc_accept4(
+			socket,
+			reinterpret_cast<sockaddr*>(&clientAddress),
+			&addressLength,
+			false
+		);
+
+		if (newSock != INVALID_SOCKET) {
+			return ClientSocket(newSock);
+		}
+
+		// Another thread may have taken the connection that woke us up
+		const int error = getLastError();
+		if (error != EAGAIN && error != EWOULDBLOCK && error != ECONNABORTED)
+			handleError(error);
+
+		waitForConnection(TIMEOUT_NEVER);
+	}
+}
+
+
+auto suc::ServerSocket::acceptAll(int timeout, size_t maxConnections, bool nonBlocking) const
+	-> std::vector<AcceptedConnection>
+{
+	std::vector<AcceptedConnection> result;
+	bool waited = false;
+
+	while (result.size() < maxConnections)
+	{
+		auto& conn = result.emplace_back();
+		conn.peerAddressLength = static_cast<int>(sizeof(conn.peerAddress));
+		SOCKET newSock = suc_accept4(
+			socket,
+			reinterpret_cast<sockaddr*>(&conn.peerAddress),
+			&conn.peerAddressLength,
+			nonBlocking
+		);
+
+		if (newSock != INVALID_SOCKET)
+		{
+			conn.socket = ClientSocket(newSock);
+			continue;
+		}
+		result.pop_back();
+
+		const int error = getLastError();
+		if (error == ECONNABORTED) {
+			continue;
+		}
+		if (error != EAGAIN && error != EWOULDBLOCK)
+		{
+			if (result.empty()) handleError(error);
+			break;
+		}
+
+		// Backlog drained
+		if (!result.empty() || waited) break;
+		if (!waitForConnection(timeout)) break;
+		waited = timeout != TIMEOUT_NEVER;
+	}
 
-	// Create ClientSocket
-	return ClientSocket(newSock);
+	return result;
+}
+
+
+auto suc::ServerSocket::asyncAccept() const -> AcceptAwaitable
+{
+	return AcceptAwaitable(socket);
 }
 
 
@@ -97,6 +167,8 @@ void suc::ServerSocket::close()
 {
 	if (_isClosed) { return; }
 
+	// Closing the descriptor alone does not wake up threads that wait in accept()
+	suc_shutdown(socket);
 	if (suc_close(socket))
 		handleLastError();
 
@@ -104,7 +176,27 @@ void suc::ServerSocket::close()
 }
 
 
+bool suc::ServerSocket::waitForConnection(int timeout) const
+{
+	pollfd pfd{};
+	pfd.fd = socket;
+	pfd.events = POLLIN;
+
+	int ready = suc_poll(&pfd, 1, timeout);
+	if (ready == -1 && getLastError() != EINTR)
+		handleLastError();
+
+	return ready > 0;
+}
+
+
 bool suc::ServerSocket::isClosed() const noexcept
 {
 	return _isClosed;
 }
+
+
+auto suc::ServerSocket::getNativeHandle() const noexcept -> SOCKET
+{
+	return socket;
+}
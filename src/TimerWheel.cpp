@@ -0,0 +1,234 @@
+#include "TimerWheel.h"
+
+#include <bit>
+#include <limits>
+
+#include "Internals.h"
+
+
+
+void suc::TimerWheel::Timer::cancel() noexcept
+{
+	if (wheel != nullptr) {
+		wheel->unlink(*this);
+	}
+}
+
+
+suc::TimerWheel::TimerWheel(std::chrono::milliseconds resolution)
+	:
+	resolution(std::max(resolution, std::chrono::milliseconds(1))),
+	start(clock::now())
+{
+}
+
+
+suc::TimerWheel::~TimerWheel() noexcept
+{
+	for (auto& level : slots)
+	{
+		for (auto& slot : level)
+		{
+			while (slot.next != &slot) {
+				unlink(static_cast<Timer&>(*slot.next));
+			}
+		}
+	}
+}
+
+
+void suc::TimerWheel::schedule(Timer& timer, std::chrono::milliseconds delay)
+{
+	if (timer.onExpire == nullptr) {
+		throw value_error("Cannot schedule a timer without a callback.");
+	}
+
+	timer.cancel();
+
+	// Round up so that timers never fire early
+	const auto due = clock::now() + std::max(delay, std::chrono::milliseconds(0)) - start;
+	timer.expiry = static_cast<ulong>((due + resolution - clock::duration(1)) / resolution);
+	timer.wheel = this;
+	timerCount++;
+	insert(timer);
+}
+
+
+auto suc::TimerWheel::advance(clock::time_point now) -> size_t
+{
+	const ulong target = toTick(now);
+	size_t fired = 0;
+
+	while (currentTick < target)
+	{
+		// Skip ticks at which nothing happens
+		const ulong next = findNextTick();
+		if (next == 0 || next > target)
+		{
+			currentTick = target;
+			break;
+		}
+		currentTick = next;
+
+		// Move timers down from higher levels when the lower level wraps around
+		for (uint level = 1; level < LEVELS; level++)
+		{
+			if ((currentTick & ((1UL << (SLOT_BITS * level)) - 1)) != 0) break;
+			cascade(level);
+		}
+
+		// Detach the slot first; callbacks may schedule timers into it
+		auto& slot = slots[0][currentTick & (SLOTS_PER_LEVEL - 1)];
+		occupied[0] &= ~(1UL << (currentTick & (SLOTS_PER_LEVEL - 1)));
+		if (slot.next == &slot) continue;
+
+		Link expired;
+		expired.next = slot.next;
+		expired.prev = slot.prev;
+		expired.next->prev = &expired;
+		expired.prev->next = &expired;
+		slot.next = slot.prev = &slot;
+		for (Link* link = expired.next; link != &expired; link = link->next) {
+			static_cast<Timer*>(link)->slot = -1;
+		}
+
+		while (expired.next != &expired)
+		{
+			auto& timer = static_cast<Timer&>(*expired.next);
+			unlink(timer);
+			fired++;
+			try {
+				timer.onExpire(timer);
+			}
+			catch (...) {
+				// Requeue the remaining timers for the next call
+				while (expired.next != &expired)
+				{
+					auto& remaining = static_cast<Timer&>(*expired.next);
+					unlink(remaining);
+					remaining.wheel = this;
+					timerCount++;
+					insert(remaining);
+				}
+				throw;
+			}
+		}
+	}
+
+	return fired;
+}
+
+
+int suc::TimerWheel::getTimeout(clock::time_point now) const noexcept
+{
+	const ulong next = findNextTick();
+	if (next == 0) {
+		return TIMEOUT_NEVER;
+	}
+
+	const auto wakeup = start + resolution * static_cast<long>(next);
+	if (wakeup <= now) {
+		return TIMEOUT_INSTANT;
+	}
+
+	const auto wait = std::chrono::ceil<std::chrono::milliseconds>(wakeup - now).count();
+	return static_cast<int>(std::min<long>(wait, std::numeric_limits<int>::max()));
+}
+
+
+auto suc::TimerWheel::size() const noexcept -> size_t
+{
+	return timerCount;
+}
+
+
+void suc::TimerWheel::insert(Timer& timer)
+{
+	// Expired timers fire on the next tick
+	const ulong expiry = std::max(timer.expiry, currentTick + 1);
+	const ulong delta = std::min(expiry - currentTick, MAX_DELTA);
+	const ulong position = currentTick + delta;
+
+	uint level = 0;
+	while (level < LEVELS - 1 && delta >= (1UL << (SLOT_BITS * (level + 1)))) {
+		level++;
+	}
+	const ulong index = (position >> (SLOT_BITS * level)) & (SLOTS_PER_LEVEL - 1);
+
+	Link& slot = slots[level][index];
+	timer.prev = slot.prev;
+	timer.next = &slot;
+	slot.prev->next = &timer;
+	slot.prev = &timer;
+	timer.slot = static_cast<int>(level * SLOTS_PER_LEVEL + index);
+	occupied[level] |= 1UL << index;
+}
+
+
+void suc::TimerWheel::unlink(Timer& timer) noexcept
+{
+	timer.prev->next = timer.next;
+	timer.next->prev = timer.prev;
+	timer.prev = timer.next = &timer;
+
+	if (timer.slot != -1)
+	{
+		const auto level = static_cast<ulong>(timer.slot) / SLOTS_PER_LEVEL;
+		const auto index = static_cast<ulong>(timer.slot) % SLOTS_PER_LEVEL;
+		const Link& slot = slots[level][index];
+		if (slot.next == &slot) {
+			occupied[level] &= ~(1UL << index);
+		}
+	}
+
+	timer.slot = -1;
+	timer.wheel = nullptr;
+	timerCount--;
+}
+
+
+void suc::TimerWheel::cascade(uint level)
+{
+	const ulong index = (currentTick >> (SLOT_BITS * level)) & (SLOTS_PER_LEVEL - 1);
+	auto& slot = slots[level][index];
+	while (slot.next != &slot)
+	{
+		auto& timer = static_cast<Timer&>(*slot.next);
+		unlink(timer);
+		timer.wheel = this;
+		timerCount++;
+		insert(timer);
+	}
+}
+
+
+auto suc::TimerWheel::findNextTick() const noexcept -> ulong
+{
+	ulong next = 0;
+	for (uint level = 0; level < LEVELS; level++)
+	{
+		if (occupied[level] == 0) continue;
+
+		// The slots after the current one, in the order in which they are processed
+		const uint shift = SLOT_BITS * level;
+		const ulong current = (currentTick >> shift) & (SLOTS_PER_LEVEL - 1);
+		const ulong rotated = std::rotr(occupied[level], static_cast<int>((current + 1) % SLOTS_PER_LEVEL));
+		const ulong distance = static_cast<ulong>(std::countr_zero(rotated)) + 1;
+
+		// Level 0 slots fire at their tick, higher slots cascade at the start of theirs
+		const ulong tick = ((currentTick >> shift) + distance) << shift;
+		if (next == 0 || tick < next) {
+			next = tick;
+		}
+	}
+
+	return next;
+}
+
+
+auto suc::TimerWheel::toTick(clock::time_point time) const noexcept -> ulong
+{
+	if (time <= start) return 0;
+
+	return static_cast<ulong>((time - start) / resolution);
+}
@@ -0,0 +1,195 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+
+
+suc::WorkerPool::WorkerPool(uint threadCount, size_t queueCapacity)
+	:
+	queueCapacity(std::max<size_t>(queueCapacity, 1))
+{
+	threadCount = std::max(threadCount, 1U);
+	for (uint i = 0; i < threadCount; i++) {
+		queues.emplace_back(std::make_unique<Queue>());
+	}
+	for (uint i = 0; i < threadCount; i++) {
+		threads.emplace_back(&WorkerPool::work, this, i);
+	}
+}
+
+
+suc::WorkerPool::~WorkerPool() noexcept
+{
+	{
+		std::lock_guard lock(sleepMutex);
+		shouldStop = true;
+	}
+	taskAvailable.notify_all();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+
+bool suc::WorkerPool::trySubmit(Task task)
+{
+	if (!tryPush(task))
+	{
+		rejectedTasks++;
+		return false;
+	}
+
+	{ std::lock_guard lock(sleepMutex); }
+	taskAvailable.notify_one();
+	return true;
+}
+
+
+void suc::WorkerPool::submit(Task task)
+{
+	if (!tryPush(task))
+	{
+		std::unique_lock lock(sleepMutex);
+		waitingSubmitters++;
+		spaceAvailable.wait(lock, [&]() { return tryPush(task); });
+		waitingSubmitters--;
+	}
+
+	{ std::lock_guard lock(sleepMutex); }
+	taskAvailable.notify_one();
+}
+
+
+auto suc::WorkerPool::getThreadCount() const noexcept -> uint
+{
+	return static_cast<uint>(threads.size());
+}
+
+
+auto suc::WorkerPool::getStats() const noexcept -> Stats
+{
+	const ulong completed = completedTasks;
+	const auto average = [completed](ulong total) {
+		return std::chrono::nanoseconds(completed > 0 ? total / completed : 0);
+	};
+
+	return {
+		pendingTasks,
+		queueCapacity * queues.size(),
+		completed,
+		rejectedTasks,
+		average(totalWaitNanos),
+		average(totalRunNanos),
+		std::chrono::nanoseconds(maxRunNanos)
+	};
+}
+
+
+bool suc::WorkerPool::tryPush(Task& task)
+{
+	const auto numQueues = static_cast<uint>(queues.size());
+	const uint first = nextQueue++;
+	for (uint i = 0; i < numQueues; i++)
+	{
+		auto& queue = *queues[(first + i) % numQueues];
+		std::lock_guard lock(queue.mutex);
+		if (queue.entries.size() < queueCapacity)
+		{
+			queue.entries.push_back({ std::move(task), clock::now() });
+			pendingTasks++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+auto suc::WorkerPool::pop(uint worker) -> std::optional<Entry>
+{
+	const auto numQueues = static_cast<uint>(queues.size());
+	std::optional<Entry> result;
+
+	// Take the oldest task from the own queue, otherwise steal the newest one
+	// from another queue. Stealing from the back keeps contention on the
+	// owner's end of the queue low.
+	for (uint i = 0; i < numQueues && !result; i++)
+	{
+		auto& queue = *queues[(worker + i) % numQueues];
+		std::lock_guard lock(queue.mutex);
+		if (queue.entries.empty()) continue;
+
+		if (i == 0)
+		{
+			result = std::move(queue.entries.front());
+			queue.entries.pop_front();
+		}
+		else
+		{
+			result = std::move(queue.entries.back());
+			queue.entries.pop_back();
+		}
+	}
+
+	if (result)
+	{
+		pendingTasks--;
+		if (waitingSubmitters > 0)
+		{
+			{ std::lock_guard lock(sleepMutex); }
+			spaceAvailable.notify_one();
+		}
+	}
+
+	return result;
+}
+
+
+void suc::WorkerPool::execute(Entry& entry) noexcept
+{
+	using std::chrono::duration_cast;
+	using std::chrono::nanoseconds;
+
+	const auto start = clock::now();
+	try {
+		entry.task();
+	}
+	catch (const std::exception& e) {
+		std::cerr << "In WorkerPool task: " << e.what() << '\n';
+	}
+	catch (...) {
+		// Anything else would terminate the program on its way out of this noexcept function
+		std::cerr << "In WorkerPool task: Unknown exception.\n";
+	}
+	const auto end = clock::now();
+
+	const auto waitNanos = static_cast<ulong>(duration_cast<nanoseconds>(start - entry.submitted).count());
+	const auto runNanos = static_cast<ulong>(duration_cast<nanoseconds>(end - start).count());
+	totalWaitNanos += waitNanos;
+	totalRunNanos += runNanos;
+
+	ulong currentMax = maxRunNanos;
+	while (runNanos > currentMax && !maxRunNanos.compare_exchange_weak(currentMax, runNanos));
+
+	completedTasks++;
+}
+
+
+void suc::WorkerPool::work(uint worker)
+{
+	while (true)
+	{
+		if (auto entry = pop(worker))
+		{
+			execute(*entry);
+			continue;
+		}
+
+		std::unique_lock lock(sleepMutex);
+		taskAvailable.wait(lock, [this]() { return shouldStop || pendingTasks > 0; });
+		if (shouldStop && pendingTasks == 0) {
+			return;
+		}
+	}
+}
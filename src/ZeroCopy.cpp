@@ -0,0 +1,270 @@
+#include "ZeroCopy.h"
+
+#include <algorithm>
+
+#include "ClientSocket.h"
+#include "Internals.h"
+
+#ifdef OS_IS_LINUX
+	#include <linux/errqueue.h>
+#endif
+
+
+
+suc::ZeroCopySender::ZeroCopySender(ClientSocket& socket, size_t threshold)
+	:
+	socket(socket.getNativeHandle()),
+	threshold(threshold)
+{
+#if defined(OS_IS_LINUX) && defined(SO_ZEROCOPY)
+	int enable = 1;
+	enabled = suc_setsockopt(this->socket, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+#endif
+}
+
+
+suc::ZeroCopySender::~ZeroCopySender() noexcept
+{
+	try {
+		flush();
+	}
+	catch (const suc_error& e) {
+		std::cerr << "In ZeroCopySender::~ZeroCopySender(): " << e.what() << '\n';
+	}
+}
+
+
+void suc::ZeroCopySender::send(std::span<const sbyte> data, Release release)
+{
+#if defined(OS_IS_LINUX) && defined(MSG_ZEROCOPY)
+	if (enabled && data.size() >= threshold)
+	{
+		// Tracked from the start, so that notifications which arrive while the socket is
+		// full are counted. The extra count keeps the buffer until send() is done with it.
+		Pending& buffer = pending.emplace_back(Pending{ nextId, nextId, 1, std::move(release) });
+		try {
+			sendCopying(sendZeroCopy(data, buffer));
+		}
+		catch (...) {
+			// Sends that did succeed still complete; the buffer is released after them
+			buffer.remaining--;
+			releaseCompleted();
+			throw;
+		}
+		buffer.remaining--;
+		releaseCompleted();
+
+		// Release buffers whose sends have already completed
+		processCompletions(TIMEOUT_INSTANT);
+		return;
+	}
+#endif
+
+	try {
+		sendCopying(data);
+	}
+	catch (...) {
+		if (release) release();
+		throw;
+	}
+	if (release) {
+		release();
+	}
+}
+
+
+auto suc::ZeroCopySender::processCompletions(int timeout) -> size_t
+{
+	size_t released = 0;
+
+#if defined(OS_IS_LINUX) && defined(MSG_ZEROCOPY)
+	while (!pending.empty())
+	{
+		// Notifications are queued on the error queue, which poll() reports as POLLERR
+		pollfd pfd{};
+		pfd.fd = socket;
+		pfd.events = 0;
+		int ready = suc_poll(&pfd, 1, released > 0 ? TIMEOUT_INSTANT : timeout);
+		if (ready == -1)
+		{
+			if (getLastError() == EINTR) continue;
+			handleLastError();
+		}
+		if (ready == 0 || !(pfd.revents & POLLERR)) break;
+
+		sbyte control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+		msghdr message{};
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+		if (recvmsg(socket, &message, MSG_ERRQUEUE | MSG_DONTWAIT) == -1)
+		{
+			if (getLastError() == EINTR) continue;
+			if (getLastError() != EAGAIN) handleLastError();
+
+			// POLLERR without a queued notification is a pending socket error
+			int error = 0;
+			int errorSize = sizeof(error);
+			suc_getsockopt(socket, SOL_SOCKET, SO_ERROR, &error, &errorSize);
+			if (error != 0) handleError(error);
+			continue;
+		}
+
+		for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg))
+		{
+			const auto* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+			if (error->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+			const size_t before = pending.size();
+			complete(error->ee_info, error->ee_data, error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED);
+			released += before - pending.size();
+		}
+	}
+#else
+	static_cast<void>(timeout);
+#endif
+
+	return released;
+}
+
+
+void suc::ZeroCopySender::flush()
+{
+	while (!pending.empty()) {
+		processCompletions(TIMEOUT_NEVER);
+	}
+}
+
+
+bool suc::ZeroCopySender::isEnabled() const noexcept
+{
+	return enabled;
+}
+
+
+auto suc::ZeroCopySender::getPendingCount() const noexcept -> size_t
+{
+	return pending.size();
+}
+
+
+auto suc::ZeroCopySender::getStats() const noexcept -> Stats
+{
+	return stats;
+}
+
+
+auto suc::ZeroCopySender::sendZeroCopy(std::span<const sbyte> data, Pending& buffer) -> std::span<const sbyte>
+{
+#if defined(OS_IS_LINUX) && defined(MSG_ZEROCOPY)
+	while (!data.empty())
+	{
+		int written = suc_send(socket, data.data(), data.size(), MSG_ZEROCOPY | MSG_NOSIGNAL);
+		if (written == -1)
+		{
+			const int error = getLastError();
+			if (error == EINTR) continue;
+			if (error == EAGAIN || error == EWOULDBLOCK)
+			{
+				waitUntilWritable();
+				continue;
+			}
+
+			// The kernel limits the memory that is pinned per socket
+			if (error == ENOBUFS && (pending.size() > 1 || buffer.remaining > 1))
+			{
+				processCompletions(TIMEOUT_NEVER);
+				continue;
+			}
+			if (error == ENOBUFS) break; // Fall back to copying
+
+			handleError(error);
+		}
+
+		buffer.lastId = nextId++;
+		buffer.remaining++;
+		stats.zeroCopySends++;
+		data = data.subspan(static_cast<size_t>(written));
+	}
+#else
+	static_cast<void>(buffer);
+#endif
+
+	return data;
+}
+
+
+void suc::ZeroCopySender::sendCopying(std::span<const sbyte> data)
+{
+	while (!data.empty())
+	{
+		int written = suc_send(socket, data.data(), data.size(), MSG_NOSIGNAL);
+		if (written == -1)
+		{
+			const int error = getLastError();
+			if (error == EINTR) continue;
+			if (error == EAGAIN || error == EWOULDBLOCK)
+			{
+				waitUntilWritable();
+				continue;
+			}
+			handleError(error);
+		}
+		stats.regularSends++;
+		data = data.subspan(static_cast<size_t>(written));
+	}
+}
+
+
+void suc::ZeroCopySender::waitUntilWritable()
+{
+	while (true)
+	{
+		pollfd pfd{};
+		pfd.fd = socket;
+		pfd.events = POLLOUT;
+		if (suc_poll(&pfd, 1, TIMEOUT_NEVER) == -1)
+		{
+			if (getLastError() == EINTR) continue;
+			handleLastError();
+		}
+
+		// Queued notifications wake up poll() as well and would keep it from waiting.
+		// Anything else is reported by the next send.
+		if ((pfd.revents & POLLOUT) || !(pfd.revents & POLLERR) || pending.empty()) return;
+		processCompletions(TIMEOUT_INSTANT);
+	}
+}
+
+
+void suc::ZeroCopySender::complete(uint firstId, uint lastId, bool copied)
+{
+	// Ids wrap around, so compare distances instead of values
+	const uint count = lastId - firstId + 1;
+	if (copied) {
+		stats.copiedSends += count;
+	}
+
+	for (auto& buffer : pending)
+	{
+		// A buffer has one id per send call, so there are only a few
+		for (uint id = buffer.firstId; buffer.remaining > 0; id++)
+		{
+			if (id - firstId < count) buffer.remaining--;
+			if (id == buffer.lastId) break;
+		}
+	}
+
+	releaseCompleted();
+}
+
+
+void suc::ZeroCopySender::releaseCompleted()
+{
+	// Release in order; the caller may rely on it to reuse buffers
+	while (!pending.empty() && pending.front().remaining == 0)
+	{
+		auto release = std::move(pending.front().release);
+		pending.pop_front();
+		if (release) release();
+	}
+}
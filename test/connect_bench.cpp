@@ -0,0 +1,76 @@
+#include <chrono>
+#include <iostream>
+
+#include <suc/SUC.h>
+
+constexpr int PORT = 1237;
+constexpr int CONNECTS = 2000;
+
+/*
+Measures ClientSocket::connect() throughput against a local server with
+the resolver cache warm and cold. Connection setup dominates on loopback,
+so the cost of the resolution itself is measured separately. */
+static double measureConnectsPerSecond(bool clearCache)
+{
+	auto& resolver = suc::Resolver::getDefault();
+	resolver.clear();
+
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < CONNECTS; i++)
+	{
+		if (clearCache) {
+			resolver.clear();
+		}
+
+		suc::ClientSocket client;
+		client.connect("localhost", PORT, suc::IPV4);
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	return CONNECTS / elapsed.count();
+}
+
+static double measureResolvesPerSecond(bool clearCache)
+{
+	auto& resolver = suc::Resolver::getDefault();
+	resolver.clear();
+
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < CONNECTS; i++)
+	{
+		if (clearCache) {
+			resolver.clear();
+		}
+		resolver.resolve("localhost", PORT, suc::IPV4);
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	return CONNECTS / elapsed.count();
+}
+
+int main()
+{
+	try
+	{
+		suc::AsyncServer server(PORT, suc::IPV4, [](suc::ClientSocket) {});
+		server.start();
+
+		const double cold = measureConnectsPerSecond(true);
+		const double warm = measureConnectsPerSecond(false);
+		server.stop();
+
+		std::cout << "Resolves per second, resolver cache cold: " << measureResolvesPerSecond(true) << "\n";
+		std::cout << "Resolves per second, resolver cache warm: " << measureResolvesPerSecond(false) << "\n";
+
+		const auto stats = suc::Resolver::getDefault().getStats();
+		std::cout << "Connects per second, resolver cache cold: " << cold << "\n";
+		std::cout << "Connects per second, resolver cache warm: " << warm << "\n";
+		std::cout << "Resolver hits: " << stats.hits << ", misses: " << stats.misses << "\n";
+	}
+	catch (const suc::suc_error& e)
+	{
+		std::cerr << e.what() << "\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include <suc/SUC.h>
+
+constexpr int ITERATIONS = 100000;
+
+// Keeps the compiler from dropping the parse results
+static volatile size_t sink = 0;
+
+/*
+Compares the incremental HttpRequestParser with the previous approach of
+splitting a copy of the request into lines, words and key-value pairs. */
+static std::string makeRequest(int headerCount)
+{
+	std::string request = "GET /index.html?user=test&page=2 HTTP/1.1\r\nHost: localhost\r\n";
+	for (int i = 1; i < headerCount; i++) {
+		request += "X-Header-" + std::to_string(i) + ": some value of a header " + std::to_string(i) + "\r\n";
+	}
+	request += "\r\n";
+
+	return request;
+}
+
+static size_t parseSplitting(std::string_view data)
+{
+	const std::string request(data);
+	const auto lines = suc::splitString(request, "\r\n");
+	const auto requestLine = suc::splitString(lines.at(0), ' ');
+
+	std::unordered_map<std::string, std::string> headers;
+	for (size_t i = 1; i < lines.size() && !lines[i].empty(); i++)
+	{
+		const auto keyValue = suc::splitString(lines[i], ':');
+		headers.try_emplace(keyValue.at(0), keyValue.at(1));
+	}
+
+	return requestLine.size() + headers.size();
+}
+
+static size_t parseIncremental(suc::HttpRequestParser& parser, std::string_view data)
+{
+	parser.reset();
+	if (parser.parse(data) != suc::HttpParseStatus::COMPLETE) {
+		throw std::runtime_error("Unable to parse request");
+	}
+
+	return parser.getHead().headers.size();
+}
+
+/*
+The lookups that the server makes for every request. The map has to be searched
+with lowercase keys, so the names are lowercased when the map is filled. */
+static size_t lookupMap(const std::unordered_map<std::string, std::string>& headers)
+{
+	size_t found = 0;
+	for (const char* name : { "connection", "content-length", "transfer-encoding" }) {
+		found += headers.count(name);
+	}
+
+	return found;
+}
+
+static size_t lookupHeaders(const suc::HttpHeaderViews& headers)
+{
+	size_t found = 0;
+	for (auto id : { suc::HttpHeaderId::CONNECTION, suc::HttpHeaderId::CONTENT_LENGTH, suc::HttpHeaderId::TRANSFER_ENCODING }) {
+		found += headers.contains(id);
+	}
+
+	return found;
+}
+
+template<typename Func>
+static double measureNanosPerRequest(Func&& parse)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < ITERATIONS; i++) {
+		sink = sink + parse();
+	}
+	const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+	return elapsed.count() / ITERATIONS;
+}
+
+int main()
+{
+	try
+	{
+		suc::HttpRequestParser parser;
+		for (int headerCount : { 1, 10, 50 })
+		{
+			const std::string request = makeRequest(headerCount);
+			const double splitting = measureNanosPerRequest([&] { return parseSplitting(request); });
+			const double incremental = measureNanosPerRequest([&] { return parseIncremental(parser, request); });
+
+			std::cout << headerCount << " headers: "
+				<< "splitting " << splitting << " ns/request, "
+				<< "incremental " << incremental << " ns/request\n";
+		}
+
+		// A typical browser request
+		const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nUser-Agent: Mozilla/5.0\r\n"
+			"Accept: text/html\r\nAccept-Language: en-US\r\nAccept-Encoding: gzip, deflate\r\n"
+			"Connection: keep-alive\r\nCookie: session=1234\r\nCache-Control: max-age=0\r\n\r\n";
+		parseIncremental(parser, request);
+		const auto& headers = parser.getHead().headers;
+		std::unordered_map<std::string, std::string> map;
+		for (const auto& field : headers)
+		{
+			std::string name(field.name);
+			std::transform(name.begin(), name.end(), name.begin(), [](char c) { return tolower(c); });
+			map.try_emplace(std::move(name), field.value);
+		}
+
+		const double mapLookup = measureNanosPerRequest([&] { return lookupMap(map); });
+		const double idLookup = measureNanosPerRequest([&] { return lookupHeaders(headers); });
+		std::cout << headers.size() << " headers, 3 lookups: "
+			<< "unordered_map " << mapLookup << " ns/request, "
+			<< "interned " << idLookup << " ns/request\n";
+	}
+	catch (const std::exception& err)
+	{
+		std::cout << "Error: " << err.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
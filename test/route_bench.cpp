@@ -0,0 +1,67 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <suc/SUC.h>
+
+constexpr int ITERATIONS = 1000000;
+
+// Keeps the compiler from dropping the match results
+static volatile size_t sink = 0;
+
+/*
+Measures HttpRouter::match() with different numbers of routes. The routes
+resemble a REST API with static resources, parameters and a few wildcards.
+The match time should not grow with the number of routes. */
+static auto makeRouter(int routeCount) -> suc::HttpRouter
+{
+	suc::HttpRouter router;
+	for (int i = 0; router.size() < static_cast<size_t>(routeCount); i++)
+	{
+		const std::string resource = "/api/v" + std::to_string(i % 3) + "/resource" + std::to_string(i);
+		router.add(suc::HttpMethod::GET, resource, {});
+		router.add(suc::HttpMethod::GET, resource + "/:id", {});
+		router.add(suc::HttpMethod::PUT, resource + "/:id", {});
+		router.add(suc::HttpMethod::GET, resource + "/:id/items/:item", {});
+		if (i % 10 == 0) {
+			router.add(suc::HttpMethod::GET, "/static" + std::to_string(i) + "/*file", {});
+		}
+	}
+
+	return router;
+}
+
+static double measureNanosPerMatch(const suc::HttpRouter& router, const std::vector<std::string>& paths)
+{
+	suc::RouteParameters parameters;
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < ITERATIONS; i++)
+	{
+		const auto match = router.match(suc::HttpMethod::GET, paths[i % paths.size()], parameters);
+		sink = sink + parameters.size() + (match.handler != nullptr);
+	}
+	const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+	return elapsed.count() / ITERATIONS;
+}
+
+int main()
+{
+	// All of these exist in every router below
+	const std::vector<std::string> paths{
+		"/api/v1/resource1",
+		"/api/v2/resource2/12345",
+		"/api/v0/resource3/12345/items/678",
+		"/static0/css/main.css",
+		"/api/v1/resource4/unknown/path",
+	};
+
+	for (int routeCount : { 20, 200, 2000 })
+	{
+		const auto router = makeRouter(routeCount);
+		std::cout << router.size() << " routes: " << measureNanosPerMatch(router, paths) << " ns/match\n";
+	}
+
+	return 0;
+}
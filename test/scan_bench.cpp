@@ -0,0 +1,110 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include <suc/SUC.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+	#define HAS_CYCLE_COUNTER
+#endif
+
+constexpr size_t BUFFER_SIZE = 1024 * 1024;
+constexpr int ITERATIONS = 200;
+
+// Keeps the compiler from dropping the scan results
+static volatile size_t sink = 0;
+
+/*
+Measures the throughput of the scanning kernels in bytes per cycle. The cycles
+are those of the time stamp counter, which runs at the nominal frequency of the
+CPU; where there is none, bytes per nanosecond are printed instead.
+
+"lines" finds every CRLF of a block of header lines, which is dominated by the
+setup cost of short scans. The others search data that does not contain
+the delimiter at all and show the peak throughput. */
+static std::string makeHeaders()
+{
+	std::string data;
+	for (int i = 0; data.size() < BUFFER_SIZE; i++) {
+		data += "X-Header-" + std::to_string(i) + ": some value of a header field\r\n";
+	}
+	data.resize(BUFFER_SIZE);
+
+	return data;
+}
+
+static auto now() -> unsigned long long
+{
+#ifdef HAS_CYCLE_COUNTER
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static double measureBytesPerCycle(const std::function<size_t()>& scan)
+{
+	const auto start = now();
+	for (int i = 0; i < ITERATIONS; i++) {
+		sink = sink + scan();
+	}
+	const auto elapsed = now() - start;
+
+	return static_cast<double>(BUFFER_SIZE) * ITERATIONS / static_cast<double>(elapsed);
+}
+
+int main()
+{
+	const std::string headers = makeHeaders();
+	const std::string plain(BUFFER_SIZE, 'a');
+
+	const std::pair<const char*, std::function<size_t()>> workloads[]{
+		{ "lines", [&] {
+			size_t lines = 0;
+			for (size_t pos = 0; (pos = suc::findSequence(headers, "\r\n", pos)) != std::string::npos; pos += 2) {
+				lines++;
+			}
+			return lines;
+		} },
+		{ "findAnyOf(\"&=\")", [&] { return suc::findAnyOf(plain, "&="); } },
+		{ "findSequence(\"\\r\\n\\r\\n\")", [&] { return suc::findSequence(headers, "\r\n\r\n"); } },
+	};
+
+	const std::pair<const char*, suc::ScanKernel> kernels[]{
+		{ "scalar", suc::ScanKernel::SCALAR },
+		{ "sse4.2", suc::ScanKernel::SSE42 },
+		{ "avx2", suc::ScanKernel::AVX2 },
+	};
+
+	const auto defaultKernel = suc::getScanKernel();
+#ifdef HAS_CYCLE_COUNTER
+	std::cout << "Bytes per cycle:\n";
+#else
+	std::cout << "Bytes per nanosecond:\n";
+#endif
+	std::cout << "memchr: " << measureBytesPerCycle([&] { return suc::findByte(plain, '\n'); }) << "\n";
+	for (const auto& [name, kernel] : kernels)
+	{
+		if (!suc::isScanKernelSupported(kernel)) {
+			std::cout << name << ": unsupported\n";
+			continue;
+		}
+
+		suc::setScanKernel(kernel);
+		std::cout << name << ":";
+		for (const auto& [workload, scan] : workloads) {
+			std::cout << "  " << workload << " " << measureBytesPerCycle(scan);
+		}
+		std::cout << "\n";
+	}
+	suc::setScanKernel(defaultKernel);
+
+	return 0;
+}